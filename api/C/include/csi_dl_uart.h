@@ -88,6 +88,9 @@ typedef enum {
     UART_EVENT_ERROR_FRAMING, /* Framing error (no effective stop bit) */
     UART_EVENT_TX_ABORT, /* Transmission aborted by calling csi_uart_stop_tx */
     UART_EVENT_RX_ABORT, /* Reception aborted by calling csi_uart_stop_rx */
+    UART_EVENT_RX_WATERMARK, /* Receive ring fill level has reached its watermark (ring mode only) */
+    UART_EVENT_TX_WATERMARK, /* Transmit ring free space has reached its watermark (ring mode only) */
+    UART_EVENT_RX_IDLE, /* Receive line has gone idle with unread data below the watermark (ring mode only) */
 } csi_uart_event_t;
 
 /*
@@ -114,6 +117,93 @@ typedef struct {
     bool tx_fifo_empty;
 } csi_uart_state_t;
 
+/*
+ * Describes one segment of a scatter-gather transfer (see csi_uart_sendv_async and
+ * csi_uart_receivev_async): base is the address of the segment and size_bytes its
+ * length in bytes.  Segments of zero length are permitted and are skipped.
+ */
+typedef struct {
+    void *base;
+    unsigned size_bytes;
+} csi_iovec_t;
+
+/*
+ * Ring buffer used for continuous transmission or reception in ring mode (see
+ * csi_uart_receive_ring and csi_uart_send_ring).  buff points to storage of
+ * size_bytes bytes, which must be a power of two.  head and tail are free-running
+ * byte counts: the producer (the driver when receiving, the application when
+ * sending) writes data at buff[head % size_bytes] and then advances head; the
+ * consumer reads data at buff[tail % size_bytes] and then advances tail.  Each
+ * index is only ever written by one side, so no locking is required provided that
+ * the csi_uart_ring_* macros are used to publish and observe index updates.
+ * watermark is the threshold, in bytes, at which UART_EVENT_RX_WATERMARK or
+ * UART_EVENT_TX_WATERMARK is signalled.  Both events use the same hysteresis: once
+ * signalled, the event is re-armed only when the level (unread bytes for
+ * reception, free space for transmission) has fallen to half the watermark,
+ * rounded down, or below, so that a ring hovering around the watermark does not
+ * cause a callback for every byte.  The structure is initialised by
+ * csi_uart_receive_ring or csi_uart_send_ring and must not be written directly by
+ * application code, other than by the csi_uart_ring_* macros.
+ */
+typedef struct {
+    uint8_t *buff;
+    unsigned size_bytes;
+    unsigned head;
+    unsigned tail;
+    unsigned watermark;
+} csi_uart_ring_t;
+
+
+/*
+ * Get the number of bytes published into a ring by the producer but not yet
+ * consumed.  Safe to call from either side of the ring without locking.
+ *
+ * @param ring: Ring previously initialised by csi_uart_receive_ring or
+ * csi_uart_send_ring.
+ * @return : Number of bytes available to the consumer.
+ */
+#define csi_uart_ring_count(ring)                                       \
+    (__atomic_load_n(&(ring)->head, __ATOMIC_ACQUIRE) -                 \
+     __atomic_load_n(&(ring)->tail, __ATOMIC_ACQUIRE))
+
+/*
+ * Get the number of bytes which the producer may write into a ring before it
+ * becomes full.  Safe to call from either side of the ring without locking.
+ *
+ * @param ring: Ring previously initialised by csi_uart_receive_ring or
+ * csi_uart_send_ring.
+ * @return : Free space in bytes.
+ */
+#define csi_uart_ring_space(ring)                                       \
+    ((ring)->size_bytes - csi_uart_ring_count(ring))
+
+/*
+ * Called by the consumer, after reading n bytes starting at buff[tail %
+ * size_bytes], to release that space back to the producer.  n must not exceed the
+ * value returned by csi_uart_ring_count.
+ *
+ * @param ring: Ring previously initialised by csi_uart_receive_ring or
+ * csi_uart_send_ring.
+ * @param n: Number of bytes consumed.
+ */
+#define csi_uart_ring_consume(ring, n)                                  \
+    __atomic_store_n(&(ring)->tail, (ring)->tail + (unsigned)(n),       \
+                     __ATOMIC_RELEASE)
+
+/*
+ * Called by the producer, after writing n bytes starting at buff[head %
+ * size_bytes], to publish them to the consumer.  n must not exceed the value
+ * returned by csi_uart_ring_space.  When the application is the producer (transmit
+ * ring mode), csi_uart_ring_notify should be called afterwards.
+ *
+ * @param ring: Ring previously initialised by csi_uart_receive_ring or
+ * csi_uart_send_ring.
+ * @param n: Number of bytes produced.
+ */
+#define csi_uart_ring_produce(ring, n)                                  \
+    __atomic_store_n(&(ring)->head, (ring)->head + (unsigned)(n),       \
+                     __ATOMIC_RELEASE)
+
 
 /*
  * Initialize a UART driver instance and associate it with a physical channel.
@@ -245,6 +335,28 @@ long csi_uart_send(csi_uart_t *uart, void *data, unsigned size_bytes, unsigned t
  */
 csi_status_t csi_uart_send_async(csi_uart_t *uart, void *data, unsigned size_bytes);
 
+/*
+ * Send data gathered from several separate buffers via UART in asynchronous mode.
+ * Behaviour is as for csi_uart_send_async, except that the data to send is
+ * described by an array of segments, which are transmitted in array order without
+ * being copied into an intermediate buffer: the driver walks the segment array
+ * directly from its transmit interrupt handler (or programs a DMA engine with it).
+ * A single UART_EVENT_SEND_COMPLETE callback is made once all segments have been
+ * sent.
+ *
+ * The segment array and the buffers it points to are read by the driver while the
+ * transfer is in progress, so they must not be modified or freed until the
+ * completion callback has been made, or csi_uart_stop_tx has been called.
+ *
+ * @param uart: Context structure for this driver instance, as passed into
+ * csi_uart_init.
+ * @param iov: Array of segments to send.
+ * @param iovcnt: Number of entries in the iov array.
+ * @return : Status code.  CSI_BUSY will be returned if a transmission is already
+ * in progress.
+ */
+csi_status_t csi_uart_sendv_async(csi_uart_t *uart, const csi_iovec_t *iov, unsigned iovcnt);
+
 /*
  * Receive data from UART in synchronous mode.  This function will block until the
  * requested length of data has been received, or until the specified timeout is
@@ -282,6 +394,110 @@ long csi_uart_receive(csi_uart_t *uart, void *data, unsigned size_bytes, unsigne
  */
 csi_status_t csi_uart_receive_async(csi_uart_t *uart, void *data, unsigned size_bytes);
 
+/*
+ * Receive data from UART into several separate buffers in asynchronous mode.
+ * Behaviour is as for csi_uart_receive_async, except that the destination is
+ * described by an array of segments, which are filled in array order: each segment
+ * is filled completely before moving to the next.  A single
+ * UART_EVENT_RECEIVE_COMPLETE callback is made once all segments have been filled.
+ *
+ * The segment array must not be modified or freed until the completion callback
+ * has been made, or csi_uart_stop_rx has been called.
+ *
+ * @param uart: Context structure for this driver instance, as passed into
+ * csi_uart_init.
+ * @param iov: Array of segments to receive into.
+ * @param iovcnt: Number of entries in the iov array.
+ * @return : Status code.  CSI_BUSY will be returned if a reception is already in
+ * progress.
+ */
+csi_status_t csi_uart_receivev_async(csi_uart_t *uart, const csi_iovec_t *iov, unsigned iovcnt);
+
+/*
+ * Start continuous reception into a ring buffer.  Prior to using this function, a
+ * callback handler must have been registered using csi_uart_register_callback.
+ * This function returns immediately.  From then on the driver (or a DMA engine
+ * under its control) writes received data directly into the ring, advancing its
+ * head index, until csi_uart_stop_rx is called.  The application consumes data in
+ * place using csi_uart_ring_count and csi_uart_ring_consume, without re-arming a
+ * transfer.  Instead of UART_EVENT_RECEIVE_COMPLETE, the callback is called with
+ * UART_EVENT_RX_WATERMARK when the number of unread bytes rises to the watermark,
+ * and is not called again for this event until the fill level has dropped to half
+ * the watermark or below and risen to it once more.  So that data below the
+ * watermark is not left unsignalled, the callback is also called with
+ * UART_EVENT_RX_IDLE when data has been received since the last
+ * UART_EVENT_RX_WATERMARK or UART_EVENT_RX_IDLE event and the receive line then
+ * stays idle for the UART's receive timeout, which is the hardware receiver
+ * timeout or idle-line detection where available, and otherwise a software timeout
+ * of at least the time taken to receive 4 characters at the configured baud rate;
+ * the BSP documentation states which is used.  If the ring becomes full, further
+ * received data is discarded and UART_EVENT_ERROR_OVERFLOW is signalled.
+ *
+ * The bytes_transferred parameter of the callback carries the number of unread
+ * bytes in the ring at the time of the event.
+ *
+ * @param uart: Context structure for this driver instance, as passed into
+ * csi_uart_init.
+ * @param ring: Ring structure to be initialised by this function and used for
+ * reception.  It must remain allocated until reception is stopped using
+ * csi_uart_stop_rx.
+ * @param buff: Storage for the ring.  The driver may require the buffer to be
+ * aligned for DMA; see BSP documentation.
+ * @param size_bytes: Size of buff in bytes.  This must be a power of two.
+ * @param watermark: Fill level in bytes at which UART_EVENT_RX_WATERMARK is
+ * signalled.  Must not exceed size_bytes.
+ * @return : Status code.  CSI_ERROR will be returned if size_bytes is not a power
+ * of two, or if no callback has been registered.  CSI_BUSY will be returned if a
+ * reception is already in progress.
+ */
+csi_status_t csi_uart_receive_ring(csi_uart_t *uart, csi_uart_ring_t *ring, void *buff, unsigned size_bytes, unsigned watermark);
+
+/*
+ * Start continuous transmission from a ring buffer.  Prior to using this function,
+ * a callback handler must have been registered using csi_uart_register_callback.
+ * This function returns immediately.  The application writes data into the ring in
+ * place and publishes it using csi_uart_ring_produce; the driver (or a DMA engine
+ * under its control) transmits published data directly from the ring, advancing
+ * its tail index, until csi_uart_stop_tx is called.  Instead of
+ * UART_EVENT_SEND_COMPLETE, the callback is called with UART_EVENT_TX_WATERMARK
+ * when the free space in the ring rises to the watermark, and is not called again
+ * for this event until the free space has fallen to half the watermark or below
+ * and risen to it once more.  If the ring drains completely, the driver idles
+ * until csi_uart_ring_notify is called.
+ *
+ * The bytes_transferred parameter of the callback carries the amount of free space
+ * in the ring at the time of the event.
+ *
+ * @param uart: Context structure for this driver instance, as passed into
+ * csi_uart_init.
+ * @param ring: Ring structure to be initialised by this function and used for
+ * transmission.  It must remain allocated until transmission is stopped using
+ * csi_uart_stop_tx.
+ * @param buff: Storage for the ring.  The driver may require the buffer to be
+ * aligned for DMA; see BSP documentation.
+ * @param size_bytes: Size of buff in bytes.  This must be a power of two.
+ * @param watermark: Free space in bytes at which UART_EVENT_TX_WATERMARK is
+ * signalled.  Must not exceed size_bytes.
+ * @return : Status code.  CSI_ERROR will be returned if size_bytes is not a power
+ * of two, or if no callback has been registered.  CSI_BUSY will be returned if a
+ * transmission is already in progress.
+ */
+csi_status_t csi_uart_send_ring(csi_uart_t *uart, csi_uart_ring_t *ring, void *buff, unsigned size_bytes, unsigned watermark);
+
+/*
+ * Inform the driver that new data has been published into a transmit ring using
+ * csi_uart_ring_produce.  This restarts transmission if the driver had idled
+ * because the ring drained.  Calling this function while transmission is still in
+ * progress has no effect, so it may be called after every publish.  It may be
+ * called from a UART callback.
+ *
+ * @param uart: Context structure for this driver instance, as passed into
+ * csi_uart_init.
+ * @return : Status code.  CSI_ERROR will be returned if the driver is not in
+ * transmit ring mode.
+ */
+csi_status_t csi_uart_ring_notify(csi_uart_t *uart);
+
 /*
  * Read a single byte from UART.  If the UART receive FIFO is empty, this function
  * will block and poll (repeatedly calling the wait function passed as the wait_fn
@@ -305,7 +521,8 @@ uint8_t csi_uart_getc(csi_uart_t *uart);
 void csi_uart_putc(csi_uart_t *uart, uint8_t data);
 
 /*
- * Cancel any in-progress transmission in asynchronous mode.
+ * Cancel any in-progress transmission in asynchronous mode.  This also ends
+ * transmit ring mode; data remaining in the ring is not transmitted.
  *
  * @param uart: Context structure for this driver instance, as passed into
  * csi_uart_init.
@@ -314,7 +531,8 @@ void csi_uart_putc(csi_uart_t *uart, uint8_t data);
 csi_status_t csi_uart_stop_tx(csi_uart_t *uart);
 
 /*
- * Cancel any in-progress reception in asynchronous mode.
+ * Cancel any in-progress reception in asynchronous mode.  This also ends receive
+ * ring mode; unread data remains in the ring.
  *
  * @param uart: Context structure for this driver instance, as passed into
  * csi_uart_init.
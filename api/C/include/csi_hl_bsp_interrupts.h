@@ -8,4 +8,14 @@ typedef struct {
     int placeholder;
 } csi_timeout_t;
 
+// Context structure for a deferred work item
+typedef struct {
+    int placeholder;
+} csi_work_t;
+
+// Shared state for a multicast software signal
+typedef struct {
+    int placeholder;
+} csi_sw_multicast_t;
+
 #endif // CSI_BSP_INTERRUPTS_H
@@ -6,12 +6,14 @@
  * presence of a "console", which is not always present in embedded systems.
  * csi_uprintf can output formatted text to 3 different places: semihosting (which
  * requires a debugger connection), UART (via the RVM-CSI UART subsystem), or a
- * circular buffer in memory. If none of these are available, for example in a
- * production system, csi_uprintf calls can easily be  nullified, effectively
- * removing them from the code.  In addition, csi_uprintf supports a limited set of
- * formatting options, giving it a much smaller code footprint than printf.
- * Finally, csi_uprintf does not require the presence of a heap; some fixed-size
- * storage for string formatting is instead allocated on the stack.
+ * circular buffer in memory. Alternatively, csi_uprintf can record its arguments
+ * in binary form for formatting later on a host machine. If none of these are
+ * available, for example in a production system, csi_uprintf calls can easily be
+ * nullified, effectively removing them from the code.  In addition, csi_uprintf
+ * supports a limited set of formatting options, giving it a much smaller code
+ * footprint than printf.  Finally, csi_uprintf does not require the presence of a
+ * heap; some fixed-size storage for string formatting is instead allocated on the
+ * stack.
  *
  * The choice of output destination is determined by a CSI_UPRINTF_OUTPUT macro
  * which should be set by application writers.
@@ -28,11 +30,43 @@
  * module may use static data, and the functions are not re-entrant.
  * Implementation of any locks necessary to prevent overlapping csi_uprintf calls
  * from different threads is left as the responsibility of the application writer.
+ * The exceptions are binary logging mode (CSI_UPRINTF_BINLOG), and circular buffer
+ * mode when configured using csi_set_uprintf_circbuff_multi; these use separate
+ * lock-free buffers for each hart and may be used from interrupt handlers.
+ *
+ * In binary logging mode, csi_uprintf does no formatting on the target.  Each call
+ * places its format string in a non-loaded ELF section named by
+ * CSI_UPRINTF_BINLOG_SECTION, and appends a record to the calling hart's log
+ * buffer containing only a record header word, the address of the format string
+ * and the raw argument words. A host-side decoder reads the log buffers (for
+ * example via a debugger or a memory dump) and formats each record using the
+ * format strings extracted from the ELF file.  The linker script must place
+ * CSI_UPRINTF_BINLOG_SECTION in a non-allocated output section (e.g. with the INFO
+ * or COPY type) so that the strings occupy no target memory.
  *
  * See section "csi_uprintf Format Conversions" section in the RVM-CSI API
  * documentation for more detailed information on the format tags supported by
  * csi_uprintf.
  *
+ * Where format parsing cost matters, the conversion functions csi_uprintf_fmt_dec,
+ * csi_uprintf_fmt_hex and csi_uprintf_fmt_str, and the macros csi_uprintf_dec,
+ * csi_uprintf_hex and csi_uprintf_str built on them, perform a single conversion
+ * with its width and padding given as arguments, so no format string is parsed at
+ * run-time.  In addition, if the application defines CSI_UPRINTF_SPECIALIZE, calls
+ * to csi_uprintf with a string literal format containing no conversions, or a
+ * single %d, %i, %x, %X or %s conversion with its argument, are resolved at
+ * compile time to direct calls to these conversion functions and
+ * csi_uprintf_write.
+ *
+ * Numeric conversions (%d, %i, %x and %X within csi_uprintf, and the
+ * csi_uprintf_fmt_* functions) must not require a hardware divide instruction.
+ * Decimal conversion should produce two digits per step using a 200-byte table of
+ * digit pairs, dividing by 100 through multiplication by a fixed-point reciprocal
+ * (or equivalent shift-and-add sequence on cores without a multiplier).
+ * Hexadecimal conversion should produce one digit per nibble by table lookup.
+ * csi_uprintf and the csi_uprintf_fmt_* functions must share these conversion
+ * routines, so that their output is identical.
+ *
  * Copyright (c) RISC-V International 2023. Creative Commons License. Auto-
  * generated file: DO NOT EDIT
  */
@@ -42,6 +76,8 @@
 
 #include "csi_dl_bsp_uart.h"
 #include "csi_types.h"
+#include <stdint.h>
+#include <stdbool.h>
 
 /*
  * Max number of characters that can be printed by a single csi_uprintf call.  This
@@ -49,6 +85,18 @@
  */
 #define CSI_UPRINTF_MAX_CHARS (80)
 
+/*
+ * Max number of characters produced by csi_uprintf_fmt_dec or csi_uprintf_fmt_hex
+ * when no width is specified
+ */
+#define CSI_UPRINTF_FMT_INT_MAX_CHARS (11)
+
+/*
+ * Max number of characters produced by csi_uprintf_fmt_dec64 or
+ * csi_uprintf_fmt_hex64 when no width is specified
+ */
+#define CSI_UPRINTF_FMT_INT64_MAX_CHARS (20)
+
 /*
  * Enumerate values for CSI_UPRINTF_OUTPUT
  */
@@ -56,6 +104,47 @@
 #define CSI_UPRINTF_SEMIHOST 1
 #define CSI_UPRINTF_UART 2
 #define CSI_UPRINTF_CIRCBUFF 3
+#define CSI_UPRINTF_BINLOG 4
+
+/*
+ * Definitions for binary logging mode: the ELF section holding format strings, the
+ * maximum number of arguments to a single csi_uprintf call, and the magic number
+ * identifying a log buffer header
+ */
+#define CSI_UPRINTF_BINLOG_SECTION ".csi_uprintf_fmt"
+#define CSI_UPRINTF_BINLOG_MAX_ARGS (8)
+#define CSI_UPRINTF_BINLOG_MAGIC (0x42495343UL)
+
+/*
+ * Record header word for a binary log record starting at free-running word index
+ * idx and occupying len words
+ */
+#define CSI_UPRINTF_BINLOG_REC_HDR(idx, len) (((unsigned long)(idx) << 8) | (unsigned long)(len))
+
+/*
+ * Magic number identifying a sub-ring header configured by
+ * csi_set_uprintf_circbuff_multi
+ */
+#define CSI_UPRINTF_CIRCBUFF_MAGIC (0x52495343UL)
+
+/*
+ * Count the arguments following the format in a call to csi_uprintf, e.g.
+ * CSI_UPRINTF_NARGS("%d %d", a, b) gives 2.  The format is included in the count
+ * and then excluded, so that no empty argument list is ever counted; this works in
+ * the ISO C modes, where a comma before an empty __VA_ARGS__ is not removed.
+ * Counts above CSI_UPRINTF_BINLOG_MAX_ARGS (up to 32 arguments) give
+ * __CSI_UPRINTF_TOO_MANY, which the csi_uprintf macro rejects at compile time in
+ * binary logging mode.
+ */
+#define __CSI_UPRINTF_TOO_MANY 255
+#define __CSI_UPRINTF_TOO_MANY8 __CSI_UPRINTF_TOO_MANY, __CSI_UPRINTF_TOO_MANY, __CSI_UPRINTF_TOO_MANY, \
+    __CSI_UPRINTF_TOO_MANY, __CSI_UPRINTF_TOO_MANY, __CSI_UPRINTF_TOO_MANY, __CSI_UPRINTF_TOO_MANY, \
+    __CSI_UPRINTF_TOO_MANY
+#define CSI_UPRINTF_NARGS(...) __CSI_UPRINTF_NARGS_(__VA_ARGS__, __CSI_UPRINTF_TOO_MANY8, \
+    __CSI_UPRINTF_TOO_MANY8, __CSI_UPRINTF_TOO_MANY8, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define __CSI_UPRINTF_NARGS_(...) __CSI_UPRINTF_NARGS(__VA_ARGS__)
+#define __CSI_UPRINTF_NARGS(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+    _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
 
 /*
  * Enumerate values for CSI_LOG_LEVEL
@@ -81,9 +170,10 @@
 
 /*
  * CSI_UPRINTF_OUTPUT determines the output destination of formatted printing using
- * cs_uprintf (Semi-hosting, UART, circular buffer or nowhere).  If
+ * cs_uprintf (Semi-hosting, UART, circular buffer, binary log or nowhere).  If
  * CSI_UPRINTF_OUTPUT is defined as CSI_UPRINTF_NONE, all csi_uprintf calls are
- * removed from the code.
+ * removed from the code.  In binary logging mode the format argument must be a
+ * string literal.
  */
 #if (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_NONE)
 #define csi_uprintf(...)
@@ -93,6 +183,139 @@
 #define csi_uprintf csi_uprintf_uart
 #elif (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_CIRCBUFF)
 #define csi_uprintf csi_uprintf_circbuff
+#elif (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_BINLOG)
+#define csi_uprintf(fmt, ...)                                                   \
+    ({                                                                          \
+        static const char __csi_fmt[]                                           \
+            __attribute__((section(CSI_UPRINTF_BINLOG_SECTION), aligned(4))) = fmt; \
+        _Static_assert(CSI_UPRINTF_NARGS(fmt, ##__VA_ARGS__) <= CSI_UPRINTF_BINLOG_MAX_ARGS, \
+                       "too many arguments to csi_uprintf in binary logging mode"); \
+        csi_uprintf_binlog(__csi_fmt, CSI_UPRINTF_NARGS(fmt, ##__VA_ARGS__), ##__VA_ARGS__); \
+    })
+#endif
+
+/*
+ * csi_uprintf_write outputs already-formatted characters to the destination
+ * selected by CSI_UPRINTF_OUTPUT, without any format parsing, and returns the
+ * number of characters output.  It is not available in binary logging mode.
+ */
+#if (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_NONE)
+#define csi_uprintf_write(str, len) ({ (void)(str); (void)(len); 0; })
+#elif (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_SEMIHOST)
+#define csi_uprintf_write csi_uprintf_write_semihost
+#elif (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_UART)
+#define csi_uprintf_write csi_uprintf_write_uart
+#elif (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_CIRCBUFF)
+#define csi_uprintf_write csi_uprintf_write_circbuff
+#endif
+
+/*
+ * If CSI_UPRINTF_SPECIALIZE is defined by the application, csi_uprintf calls whose
+ * format is a string literal are dispatched at compile time where possible.  A
+ * call with no further arguments and no % characters in the format becomes a
+ * single call to csi_uprintf_write.  A call with one further argument, whose
+ * format contains a single %d, %i, %x, %X or %s conversion with an optional 0 flag
+ * (not for %s) and an optional width of one or two digits (up to
+ * CSI_UPRINTF_MAX_CHARS), and is no longer than CSI_UPRINTF_MAX_CHARS characters,
+ * becomes a call to csi_uprintf_fmt_dec, csi_uprintf_fmt_hex or
+ * csi_uprintf_fmt_str, with the surrounding literal text copied around the
+ * converted value, followed by a single call to csi_uprintf_write.  The format is
+ * examined using __builtin_strchr and constant character reads, so dispatch only
+ * happens when the compiler folds these (in practice, when optimizing); all other
+ * calls are passed through to the csi_uprintf implementation for the selected
+ * output, which also retains printf format checking.  The argument is evaluated
+ * exactly once.  This has no effect when CSI_UPRINTF_OUTPUT is CSI_UPRINTF_NONE or
+ * CSI_UPRINTF_BINLOG.
+ */
+#if defined(CSI_UPRINTF_SPECIALIZE) && (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_SEMIHOST)
+#define __CSI_UPRINTF_DYNAMIC csi_uprintf_semihost
+#elif defined(CSI_UPRINTF_SPECIALIZE) && (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_UART)
+#define __CSI_UPRINTF_DYNAMIC csi_uprintf_uart
+#elif defined(CSI_UPRINTF_SPECIALIZE) && (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_CIRCBUFF)
+#define __CSI_UPRINTF_DYNAMIC csi_uprintf_circbuff
+#endif
+
+#ifdef __CSI_UPRINTF_DYNAMIC
+/* Parts of a format with a single conversion: the %, the first width digit and the conversion character */
+#define __CSI_UPRINTF_PCT(fmt)      __builtin_strchr((fmt), '%')
+#define __CSI_UPRINTF_ZERO(fmt)     (__CSI_UPRINTF_PCT(fmt)[1] == '0')
+#define __CSI_UPRINTF_WPOS(fmt)     (__CSI_UPRINTF_PCT(fmt) + 1 + __CSI_UPRINTF_ZERO(fmt))
+#define __CSI_UPRINTF_DIGIT(c)      ((c) >= '0' && (c) <= '9')
+#define __CSI_UPRINTF_WLEN(fmt)                                                 \
+    (__CSI_UPRINTF_DIGIT(__CSI_UPRINTF_WPOS(fmt)[0])                            \
+         ? (__CSI_UPRINTF_DIGIT(__CSI_UPRINTF_WPOS(fmt)[1]) ? 2 : 1) : 0)
+#define __CSI_UPRINTF_WIDTH(fmt)                                                \
+    (__CSI_UPRINTF_WLEN(fmt) == 2                                               \
+         ? (unsigned)(__CSI_UPRINTF_WPOS(fmt)[0] - '0') * 10 +                  \
+               (unsigned)(__CSI_UPRINTF_WPOS(fmt)[1] - '0')                     \
+         : __CSI_UPRINTF_WLEN(fmt) == 1 ? (unsigned)(__CSI_UPRINTF_WPOS(fmt)[0] - '0') : 0u)
+#define __CSI_UPRINTF_CPOS(fmt)     (__CSI_UPRINTF_WPOS(fmt) + __CSI_UPRINTF_WLEN(fmt))
+#define __CSI_UPRINTF_CONV(fmt)     (__CSI_UPRINTF_CPOS(fmt)[0])
+/*
+ * Non-zero if a format with one argument can be dispatched.  Bitwise operators are used so that
+ * __builtin_constant_p can fold the whole expression; a format without a % never folds, and is passed through.
+ */
+#define __CSI_UPRINTF_SPEC1_OK(fmt)                                             \
+    ((__builtin_strlen(fmt) <= CSI_UPRINTF_MAX_CHARS) &                         \
+     (__CSI_UPRINTF_WIDTH(fmt) <= CSI_UPRINTF_MAX_CHARS) &                      \
+     ((__CSI_UPRINTF_CONV(fmt) == 'd') | (__CSI_UPRINTF_CONV(fmt) == 'i') |     \
+      (__CSI_UPRINTF_CONV(fmt) == 'x') | (__CSI_UPRINTF_CONV(fmt) == 'X') |     \
+      ((__CSI_UPRINTF_CONV(fmt) == 's') & !__CSI_UPRINTF_ZERO(fmt))) &          \
+     (__builtin_strchr(__CSI_UPRINTF_CPOS(fmt) + 1, '%') == 0))
+
+/* Select the argument for the integer or string emitter; the other is passed a dummy value */
+#define __CSI_UPRINTF_ARG_INT(a)    __builtin_choose_expr(__builtin_classify_type(a) == 5, 0, (a))
+#define __CSI_UPRINTF_ARG_STR(a)    __builtin_choose_expr(__builtin_classify_type(a) == 5, (a), "")
+
+#define __CSI_UPRINTF_CONV1(fmt, a)                                             \
+    ({                                                                          \
+        char __b[2 * CSI_UPRINTF_MAX_CHARS];                                    \
+        unsigned __pre = (unsigned)(__CSI_UPRINTF_PCT(fmt) - (fmt));            \
+        char const *__suf = __CSI_UPRINTF_CPOS(fmt) + 1;                        \
+        unsigned __sufl = __builtin_strlen(__suf);                              \
+        unsigned __n;                                                           \
+        __builtin_memcpy(__b, (fmt), __pre);                                    \
+        if (__CSI_UPRINTF_CONV(fmt) == 's')                                     \
+            __n = csi_uprintf_fmt_str(__b + __pre, __CSI_UPRINTF_ARG_STR(a),    \
+                                      __CSI_UPRINTF_WIDTH(fmt));                \
+        else if (__CSI_UPRINTF_CONV(fmt) == 'x' || __CSI_UPRINTF_CONV(fmt) == 'X') \
+            __n = csi_uprintf_fmt_hex(__b + __pre, __CSI_UPRINTF_ARG_INT(a),    \
+                                      __CSI_UPRINTF_WIDTH(fmt), __CSI_UPRINTF_ZERO(fmt), \
+                                      __CSI_UPRINTF_CONV(fmt) == 'X');          \
+        else                                                                    \
+            __n = csi_uprintf_fmt_dec(__b + __pre, __CSI_UPRINTF_ARG_INT(a),    \
+                                      __CSI_UPRINTF_WIDTH(fmt), __CSI_UPRINTF_ZERO(fmt)); \
+        __builtin_memcpy(__b + __pre + __n, __suf, __sufl);                     \
+        csi_uprintf_write(__b, __pre + __n + __sufl);                           \
+    })
+
+/* Dispatch on the number of arguments following the format */
+#define __CSI_UPRINTF_SPEC_0(fmt)                                               \
+    (__builtin_constant_p(__builtin_strchr((fmt), '%') == 0) &&                 \
+     (__builtin_strchr((fmt), '%') == 0)                                        \
+         ? csi_uprintf_write((fmt), __builtin_strlen(fmt))                      \
+         : __CSI_UPRINTF_DYNAMIC(fmt))
+#define __CSI_UPRINTF_SPEC_1(fmt, arg)                                          \
+    ({                                                                          \
+        __auto_type __a = (arg);                                                \
+        __builtin_constant_p(__CSI_UPRINTF_SPEC1_OK(fmt)) && __CSI_UPRINTF_SPEC1_OK(fmt) \
+            ? __CSI_UPRINTF_CONV1(fmt, __a)                                     \
+            : __CSI_UPRINTF_DYNAMIC((fmt), __a);                                \
+    })
+#define __CSI_UPRINTF_SPEC_2 __CSI_UPRINTF_DYNAMIC
+#define __CSI_UPRINTF_SPEC_3 __CSI_UPRINTF_DYNAMIC
+#define __CSI_UPRINTF_SPEC_4 __CSI_UPRINTF_DYNAMIC
+#define __CSI_UPRINTF_SPEC_5 __CSI_UPRINTF_DYNAMIC
+#define __CSI_UPRINTF_SPEC_6 __CSI_UPRINTF_DYNAMIC
+#define __CSI_UPRINTF_SPEC_7 __CSI_UPRINTF_DYNAMIC
+#define __CSI_UPRINTF_SPEC_8 __CSI_UPRINTF_DYNAMIC
+#define __CSI_UPRINTF_SPEC_255 __CSI_UPRINTF_DYNAMIC
+#define __CSI_UPRINTF_SPEC_(n)      __CSI_UPRINTF_SPEC_ ## n
+#define __CSI_UPRINTF_SPEC(n)       __CSI_UPRINTF_SPEC_(n)
+
+#undef csi_uprintf
+#define csi_uprintf(fmt, ...)                                                   \
+    __CSI_UPRINTF_SPEC(CSI_UPRINTF_NARGS(fmt, ##__VA_ARGS__))(fmt, ##__VA_ARGS__)
 #endif
 
 /*
@@ -134,11 +357,170 @@
 #endif
 
 
+/*
+ * Header placed at the start of each hart's binary log buffer by
+ * csi_set_uprintf_binlog, allowing a host-side decoder to locate and parse the
+ * log.  magic holds CSI_UPRINTF_BINLOG_MAGIC.  hartid identifies the hart owning
+ * the buffer.  size_words is the number of unsigned long words in the circular log
+ * area which immediately follows the header, and is a power of two no greater than
+ * 2^(XLEN - 8).  write_idx is the free-running index of the next word to be
+ * written.  Each record in the log area occupies 2 + nargs words: a record header
+ * word, the address of the format string, and nargs argument words.  The record
+ * header word is CSI_UPRINTF_BINLOG_REC_HDR(idx, len), where idx is the free-
+ * running index of the record's first word and len is 2 + nargs; since len is at
+ * least 2, a complete header is never 0, and a header word equal to 0 marks a
+ * record which is still being written.  A record is valid only if its header word
+ * holds its own index. To decode a log which may have wrapped, a decoder starts at
+ * index write_idx - size_words (or 0, if write_idx is less than size_words) and
+ * resynchronises by scanning forward one word at a time until it finds a word at
+ * index i equal to CSI_UPRINTF_BINLOG_REC_HDR(i, len) with len from 2 to 2 +
+ * CSI_UPRINTF_BINLOG_MAX_ARGS, and whose following word is the address of a string
+ * in CSI_UPRINTF_BINLOG_SECTION.  From there it steps from record to record using
+ * len.  A header word which is 0, or does not hold its own index (because the
+ * record is being overwritten), ends the decode at that point; the decoder then
+ * resynchronises from the next word if required.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t hartid;
+    unsigned long size_words;
+    unsigned long write_idx;
+} csi_uprintf_binlog_hdr_t;
+
+/*
+ * Header placed at the start of each sub-ring by csi_set_uprintf_circbuff_multi.
+ * magic holds CSI_UPRINTF_CIRCBUFF_MAGIC.  hartid and depth identify the owner of
+ * the sub-ring.  size_bytes is the size of the data area, and is a multiple of 8.
+ * The data area immediately follows the header; the header is 24 bytes long, so
+ * the data area, like the header, is aligned to 8 bytes.  write_idx is the free-
+ * running offset of the next byte to be written, and is only written by the owning
+ * hart.  read_idx is the free-running offset of the next byte to be read, and is
+ * only written by the reader.  Records are never overwritten before they have been
+ * read: if a new record does not fit in the space between write_idx and read_idx +
+ * size_bytes, it is discarded and dropped is incremented instead.  dropped is only
+ * written by the owning hart; a reader may report it, and compare it with a
+ * previously seen value to detect records lost since then.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t hartid;
+    uint16_t depth;
+    uint32_t size_bytes;
+    uint32_t write_idx;
+    uint32_t read_idx;
+    uint32_t dropped;
+} csi_uprintf_circbuff_hdr_t;
+
+/*
+ * Header preceding each record within a sub-ring configured by
+ * csi_set_uprintf_circbuff_multi.  timestamp is the value of csi_read_mtime when
+ * the record was written, and length the number of characters of text which follow
+ * the header.  Records are padded to a multiple of 8 bytes, so every record starts
+ * at an offset within the data area which is a multiple of 8, and may wrap around
+ * the end of the data area.
+ */
+typedef struct {
+    uint64_t timestamp;
+    uint32_t length;
+    uint32_t reserved;
+} csi_uprintf_circbuff_rec_t;
+
+
+/*
+ * Output a signed integer in decimal, equivalent to csi_uprintf("%d", val) with
+ * the given width and padding, without any format parsing.  Uses
+ * csi_uprintf_fmt_dec and csi_uprintf_write.
+ *
+ * @param val: Value to output.
+ * @param width: Minimum number of characters to output (0 for no minimum).
+ * @param zero_pad: True to pad to width with zeros, false to pad with spaces.
+ * @return : Number of characters printed.  A negative number indicates an error.
+ * If CSI_UPRINTF_OUTPUT is CSI_UPRINTF_NONE, nothing is output and 0 is returned.
+ * In binary logging mode the value is recorded using csi_uprintf with a "%*d" or
+ * "%0*d" format, for formatting on the host, and the return value is as for
+ * csi_uprintf.
+ */
+#if (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_NONE)
+#define csi_uprintf_dec(val, width, zero_pad)                                 \
+    ({ (void)(val); (void)(width); (void)(zero_pad); 0; })
+#elif (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_BINLOG)
+#define csi_uprintf_dec(val, width, zero_pad)                                 \
+    ((zero_pad) ? csi_uprintf("%0*d", (int)(width), (int)(val))               \
+                : csi_uprintf("%*d", (int)(width), (int)(val)))
+#else
+#define csi_uprintf_dec(val, width, zero_pad)                                 \
+    ({                                                                        \
+        char __b[CSI_UPRINTF_MAX_CHARS];                                      \
+        csi_uprintf_write(__b, csi_uprintf_fmt_dec(__b, (val), (width), (zero_pad))); \
+    })
+#endif
+
+/*
+ * Output an unsigned integer in hexadecimal, equivalent to csi_uprintf("%x", val)
+ * or csi_uprintf("%X", val) with the given width and padding, without any format
+ * parsing.  Uses csi_uprintf_fmt_hex and csi_uprintf_write.
+ *
+ * @param val: Value to output.
+ * @param width: Minimum number of characters to output (0 for no minimum).
+ * @param zero_pad: True to pad to width with zeros, false to pad with spaces.
+ * @param upper_case: True to use upper-case digits, false for lower-case.
+ * @return : Number of characters printed.  A negative number indicates an error.
+ * If CSI_UPRINTF_OUTPUT is CSI_UPRINTF_NONE, nothing is output and 0 is returned.
+ * In binary logging mode the value is recorded using csi_uprintf with a "%*x",
+ * "%0*x", "%*X" or "%0*X" format, and the return value is as for csi_uprintf.
+ */
+#if (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_NONE)
+#define csi_uprintf_hex(val, width, zero_pad, upper_case)                     \
+    ({ (void)(val); (void)(width); (void)(zero_pad); (void)(upper_case); 0; })
+#elif (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_BINLOG)
+#define csi_uprintf_hex(val, width, zero_pad, upper_case)                     \
+    ((upper_case) ? ((zero_pad) ? csi_uprintf("%0*X", (int)(width), (unsigned)(val)) \
+                                : csi_uprintf("%*X", (int)(width), (unsigned)(val))) \
+                  : ((zero_pad) ? csi_uprintf("%0*x", (int)(width), (unsigned)(val)) \
+                                : csi_uprintf("%*x", (int)(width), (unsigned)(val))))
+#else
+#define csi_uprintf_hex(val, width, zero_pad, upper_case)                     \
+    ({                                                                        \
+        char __b[CSI_UPRINTF_MAX_CHARS];                                      \
+        csi_uprintf_write(__b, csi_uprintf_fmt_hex(__b, (val), (width), (zero_pad), (upper_case))); \
+    })
+#endif
+
+/*
+ * Output a string padded to the given width, equivalent to csi_uprintf("%s", str),
+ * without any format parsing.  Uses csi_uprintf_fmt_str and csi_uprintf_write.
+ *
+ * @param str: Null-terminated string to output.
+ * @param width: Minimum number of characters to output (0 for no minimum).
+ * @return : Number of characters printed.  A negative number indicates an error.
+ * If CSI_UPRINTF_OUTPUT is CSI_UPRINTF_NONE, nothing is output and 0 is returned.
+ * In binary logging mode the string is recorded using csi_uprintf with a "%*s"
+ * format, so it is subject to the same restrictions as other %s arguments in that
+ * mode, and the return value is as for csi_uprintf.
+ */
+#if (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_NONE)
+#define csi_uprintf_str(str, width)                                           \
+    ({ (void)(str); (void)(width); 0; })
+#elif (CSI_UPRINTF_OUTPUT == CSI_UPRINTF_BINLOG)
+#define csi_uprintf_str(str, width)                                           \
+    csi_uprintf("%*s", (int)(width), (char const *)(str))
+#else
+#define csi_uprintf_str(str, width)                                           \
+    ({                                                                        \
+        char __b[CSI_UPRINTF_MAX_CHARS];                                      \
+        csi_uprintf_write(__b, csi_uprintf_fmt_str(__b, (str), (width)));     \
+    })
+#endif
+
+
 /*
  * Configure a circular buffer for use by csi_uprintf when CSI_UPRINTF_OUTPUT is
  * defined as CSI_UPRINTF_CIRCBUFF.  This function must be called once, before ever
  * calling csi_uprintf in that case, and before ever calling csi_uprintf_circbuff.
- * It does not need to be called if not using circular buffer output mode.
+ * It does not need to be called if not using circular buffer output mode.  The
+ * buffer configured by this function is shared by all callers, so overlapping
+ * calls must be serialized by the application; csi_set_uprintf_circbuff_multi may
+ * be used instead to avoid this.
  *
  * @param buff: Pointer to circular buffer to use for console output.
  * @param size_bytes: Circular buffer size in bytes.
@@ -146,6 +528,64 @@
  */
 csi_status_t csi_set_uprintf_circbuff(void *buff, unsigned size_bytes);
 
+/*
+ * Configure circular buffer output for csi_uprintf for use by multiple harts
+ * without locking.  This is an alternative to csi_set_uprintf_circbuff, and is
+ * used when CSI_UPRINTF_OUTPUT is defined as CSI_UPRINTF_CIRCBUFF.  The supplied
+ * buffer is divided equally into num_harts * num_depths sub-rings, one for each
+ * combination of hart and trap nesting depth (depth 0 being regular execution
+ * outside of any trap handler, depth 1 a handler which interrupted it, and so on,
+ * as counted by the base trap handler on entry and exit). Each
+ * csi_uprintf_circbuff call writes only to the sub-ring belonging to the calling
+ * hart and its current nesting depth.  Since code can only be preempted by a trap
+ * at a greater depth, each sub-ring has a single writer which cannot be
+ * interrupted by another writer to the same sub-ring, whether or not interrupt
+ * levels are supported and whether or not preemption is enabled (see
+ * csi_set_preemption).  No locks, atomic read-modify-write operations or interrupt
+ * disabling are therefore needed, and harts do not contend with one another.  On a
+ * hart where the RVM-CSI trap handling sub-system is not in use, every call is at
+ * depth 0, so csi_uprintf must not then be called from trap handlers. Each record
+ * in a sub-ring is prefixed by a csi_uprintf_circbuff_rec_t header holding the
+ * value of csi_read_mtime at the time of the call, allowing a reader to merge the
+ * output of all sub-rings in time order (see csi_uprintf_circbuff_read).  When a
+ * sub-ring does not have space for a new record, the record is dropped and counted
+ * in the sub-ring header, so records already written are always intact.  This
+ * function must be called once, on one hart, before any hart calls csi_uprintf.
+ *
+ * @param buff: Pointer to buffer to use for console output.  Must be aligned to 8
+ * bytes.
+ * @param size_bytes: Buffer size in bytes.
+ * @param num_harts: Number of harts which will call csi_uprintf.  Hart IDs 0 to
+ * num_harts - 1 are supported.
+ * @param num_depths: Number of trap nesting depths from which csi_uprintf will be
+ * called, including depth 0.  This is 1 if csi_uprintf is only called outside trap
+ * handlers, 2 if it is also called from handlers which cannot be preempted, and so
+ * on.  Calls made at a depth greater than or equal to num_depths share the sub-
+ * ring of the deepest depth, and are only safe if a handler at that depth cannot
+ * be preempted by another which also calls csi_uprintf.
+ * @return : Status of operation.  CSI_ERROR will be returned if the buffer is too
+ * small to hold a sub-ring header and a record of CSI_UPRINTF_MAX_CHARS characters
+ * for each sub-ring.
+ */
+csi_status_t csi_set_uprintf_circbuff_multi(void *buff, unsigned size_bytes, unsigned num_harts, unsigned num_depths);
+
+/*
+ * Read and remove text from the circular buffers configured by
+ * csi_set_uprintf_circbuff_multi, merging the records from all sub-rings in order
+ * of their timestamps.  Only whole records are copied, and read_idx of each sub-
+ * ring is advanced past the records copied, freeing their space for new records.
+ * This function may be called from any hart while other harts continue to log, but
+ * must not be called concurrently by more than one reader.  A host-side tool may
+ * alternatively read the sub-rings directly from memory, using the layout
+ * described by csi_uprintf_circbuff_hdr_t and csi_uprintf_circbuff_rec_t.
+ *
+ * @param out: Buffer to receive merged text.  Output is not null-terminated.
+ * @param size_bytes: Size of the out buffer in bytes.
+ * @return : Number of characters copied into out.  A negative number indicates an
+ * error, e.g. if csi_set_uprintf_circbuff_multi has not been called.
+ */
+int csi_uprintf_circbuff_read(char *out, unsigned size_bytes);
+
 /*
  * Configure csi_uprintf operation for use when CSI_UPRINTF_OUTPUT is defined as
  * CSI_UPRINTF_UART.  This function must be called once, before ever calling
@@ -158,6 +598,181 @@ csi_status_t csi_set_uprintf_circbuff(void *buff, unsigned size_bytes);
  */
 csi_status_t csi_set_uprintf_uart(csi_uart_t *uart);
 
+/*
+ * Configure the binary log buffer for the calling hart, for use by csi_uprintf
+ * when CSI_UPRINTF_OUTPUT is defined as CSI_UPRINTF_BINLOG.  This function must be
+ * called once on each hart which will log, before that hart first calls
+ * csi_uprintf, with a separate buffer for each hart.  The function writes a
+ * csi_uprintf_binlog_hdr_t header at the start of the buffer and uses the
+ * remainder as a circular log of records; once the log is full, the oldest records
+ * are overwritten.  It does not need to be called if not using binary logging
+ * mode.
+ *
+ * @param buff: Pointer to the log buffer for this hart.  Must be aligned to the
+ * size of unsigned long.
+ * @param size_bytes: Log buffer size in bytes, including the header.  The space
+ * following the header is rounded down to a power-of-two number of words.
+ * @return : Status of operation.  CSI_ERROR will be returned if the buffer is too
+ * small to hold a header and one record.
+ */
+csi_status_t csi_set_uprintf_binlog(void *buff, unsigned size_bytes);
+
+/*
+ * Binary logging version of csi_uprintf.  This is not normally called directly by
+ * application writers. Rather, call csi_uprintf and define CSI_UPRINTF_OUTPUT to
+ * be CSI_UPRINTF_BINLOG; the csi_uprintf macro then places the format string in
+ * CSI_UPRINTF_BINLOG_SECTION and supplies the argument count.  The function
+ * reserves 2 + nargs words for the record in the calling hart's log buffer with a
+ * single atomic add to the write index, so that a call interrupted by another
+ * csi_uprintf call on the same hart produces two intact records.  It then stores 0
+ * to the record's header word, so that a decoder cannot mistake a partly-
+ * overwritten earlier record for a complete one; stores the format string address
+ * and the arguments, each as one unsigned long word; and finally stores the record
+ * header word (see csi_uprintf_binlog_hdr_t) with release ordering to publish the
+ * record.  No formatting is performed.
+ *
+ * Arguments wider than unsigned long are not supported.  %s arguments are recorded
+ * as pointers, so the host decoder can only print strings which are held in read-
+ * only data within the ELF file.
+ *
+ * @param fmt: Formatted string matching that used by printf, located in
+ * CSI_UPRINTF_BINLOG_SECTION
+ * @param nargs: Number of variable arguments following, at most
+ * CSI_UPRINTF_BINLOG_MAX_ARGS
+ * @return : Number of words recorded.  A negative number indicates an error, e.g.
+ * if csi_set_uprintf_binlog has not been called on this hart.
+ */
+int csi_uprintf_binlog(char const *fmt, unsigned nargs, ...) __attribute__((format(printf, 1, 3)));
+
+/*
+ * Semi-hosting version of csi_uprintf_write, which outputs a string of already-
+ * formatted characters without parsing it.  This is not normally called directly
+ * by application writers.  Rather, call csi_uprintf_write and define
+ * CSI_UPRINTF_OUTPUT to be CSI_UPRINTF_SEMIHOST.
+ *
+ * @param str: Characters to output.  Need not be null-terminated.
+ * @param len: Number of characters to output.  Output is truncated to
+ * CSI_UPRINTF_MAX_CHARS characters.
+ * @return : Number of characters printed.  A negative number indicates an error.
+ */
+int csi_uprintf_write_semihost(char const *str, unsigned len);
+
+/*
+ * Circular buffering version of csi_uprintf_write, which outputs a string of
+ * already-formatted characters without parsing it.  This is not normally called
+ * directly by application writers.  Rather, call csi_uprintf_write and define
+ * CSI_UPRINTF_OUTPUT to be CSI_UPRINTF_CIRCBUFF.
+ *
+ * @param str: Characters to output.  Need not be null-terminated.
+ * @param len: Number of characters to output.  Output is truncated to
+ * CSI_UPRINTF_MAX_CHARS characters.
+ * @return : Number of characters printed.  A negative number indicates an error.
+ */
+int csi_uprintf_write_circbuff(char const *str, unsigned len);
+
+/*
+ * UART version of csi_uprintf_write, which outputs a string of already-formatted
+ * characters without parsing it.  This is not normally called directly by
+ * application writers.  Rather, call csi_uprintf_write and define
+ * CSI_UPRINTF_OUTPUT to be CSI_UPRINTF_UART.
+ *
+ * @param str: Characters to output.  Need not be null-terminated.
+ * @param len: Number of characters to output.  Output is truncated to
+ * CSI_UPRINTF_MAX_CHARS characters.
+ * @return : Number of characters printed.  A negative number indicates an error.
+ */
+int csi_uprintf_write_uart(char const *str, unsigned len);
+
+/*
+ * Convert a signed integer to decimal text, exactly as csi_uprintf would for a %d
+ * conversion with the given width and flags.  The text is written to out and is
+ * not null-terminated.  This function does not depend on the output destination,
+ * and may be used by application code to build output without format parsing.
+ *
+ * @param out: Buffer to receive the text.  Must have space for at least
+ * CSI_UPRINTF_FMT_INT_MAX_CHARS characters, or for width characters if greater.
+ * @param val: Value to convert.
+ * @param width: Minimum number of characters to output (0 for no minimum); limited
+ * to CSI_UPRINTF_MAX_CHARS.
+ * @param zero_pad: True to pad to width with zeros (as for the 0 flag), false to
+ * pad with spaces.
+ * @return : Number of characters written to out.
+ */
+unsigned csi_uprintf_fmt_dec(char *out, int val, unsigned width, bool zero_pad);
+
+/*
+ * Convert an unsigned integer to hexadecimal text, exactly as csi_uprintf would
+ * for a %x or %X conversion with the given width and flags.  The text is written
+ * to out and is not null-terminated.
+ *
+ * @param out: Buffer to receive the text.  Must have space for at least
+ * CSI_UPRINTF_FMT_INT_MAX_CHARS characters, or for width characters if greater.
+ * @param val: Value to convert.
+ * @param width: Minimum number of characters to output (0 for no minimum); limited
+ * to CSI_UPRINTF_MAX_CHARS.
+ * @param zero_pad: True to pad to width with zeros (as for the 0 flag), false to
+ * pad with spaces.
+ * @param upper_case: True to use upper-case digits (as for %X), false for lower-
+ * case (as for %x).
+ * @return : Number of characters written to out.
+ */
+unsigned csi_uprintf_fmt_hex(char *out, unsigned val, unsigned width, bool zero_pad, bool upper_case);
+
+/*
+ * Convert a signed 64-bit integer to decimal text, with width and padding as for
+ * csi_uprintf_fmt_dec.  The text is written to out and is not null-terminated.  No
+ * 64-bit division routine is called.  The magnitude of val is split into at most
+ * three chunks, each below 10^8, by dividing by 10^8 at most twice; each division
+ * is performed by multiplying by a fixed-point reciprocal of 10^8 and taking the
+ * high 64 bits of the 128-bit product (built from 32 x 32-bit mul and mulhu
+ * instructions on RV32), followed by a single correction step which adds 1 to the
+ * quotient if the remainder is still at least 10^8.  Each chunk is then converted
+ * with the 32-bit decimal routine shared with csi_uprintf_fmt_dec, with the lower
+ * chunks padded to 8 digits.
+ *
+ * @param out: Buffer to receive the text.  Must have space for at least
+ * CSI_UPRINTF_FMT_INT64_MAX_CHARS characters, or for width characters if greater.
+ * @param val: Value to convert.
+ * @param width: Minimum number of characters to output (0 for no minimum); limited
+ * to CSI_UPRINTF_MAX_CHARS.
+ * @param zero_pad: True to pad to width with zeros (as for the 0 flag), false to
+ * pad with spaces.
+ * @return : Number of characters written to out.
+ */
+unsigned csi_uprintf_fmt_dec64(char *out, int64_t val, unsigned width, bool zero_pad);
+
+/*
+ * Convert an unsigned 64-bit integer to hexadecimal text, with width and padding
+ * as for csi_uprintf_fmt_hex. The text is written to out and is not null-
+ * terminated.
+ *
+ * @param out: Buffer to receive the text.  Must have space for at least
+ * CSI_UPRINTF_FMT_INT64_MAX_CHARS characters, or for width characters if greater.
+ * @param val: Value to convert.
+ * @param width: Minimum number of characters to output (0 for no minimum); limited
+ * to CSI_UPRINTF_MAX_CHARS.
+ * @param zero_pad: True to pad to width with zeros (as for the 0 flag), false to
+ * pad with spaces.
+ * @param upper_case: True to use upper-case digits (as for %X), false for lower-
+ * case (as for %x).
+ * @return : Number of characters written to out.
+ */
+unsigned csi_uprintf_fmt_hex64(char *out, uint64_t val, unsigned width, bool zero_pad, bool upper_case);
+
+/*
+ * Copy a string, padded on the left with spaces to the given width, exactly as
+ * csi_uprintf would for a %s conversion.  The text is written to out and is not
+ * null-terminated.
+ *
+ * @param out: Buffer to receive the text.  Must have space for at least
+ * CSI_UPRINTF_MAX_CHARS characters.
+ * @param str: Null-terminated string to copy.
+ * @param width: Minimum number of characters to output (0 for no minimum).
+ * @return : Number of characters written to out, which is at most
+ * CSI_UPRINTF_MAX_CHARS.
+ */
+unsigned csi_uprintf_fmt_str(char *out, char const *str, unsigned width);
+
 /*
  * Semi-hosting version of csi_uprintf.  This is not normally called directly by
  * application writers. Rather, call csi_uprintf and define CSI_UPRINTF_OUTPUT to
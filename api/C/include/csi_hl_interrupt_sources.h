@@ -42,6 +42,7 @@ typedef enum {
     CSI_ENUM_INST_PAGE_FAULT, /* Instruction page-fault */
     CSI_ENUM_LOAD_PAGE_FAULT, /* Load page-fault */
     CSI_ENUM_STORE_PAGE_FAULT, /* Store page-fault */
+    CSI_ENUM_COUNTER_OVERFLOW_INTERRUPT, /* Local counter overflow interrupt (Sscofpmf extension) */
     CSI_NUM_STANDARD_TRAP_SOURCES, /* Must come last in this list */
 } csi_trap_source_t;
 
@@ -19,7 +19,10 @@
  * would normally be used by compiled C code without the use of special compiler
  * intrinsics (the exact register set is platform-dependent and may be documented
  * by the BSP). Other registers manipulated by the user's handler (such as
- * platform-specific CSRs etc.) should be saved and restored by that handler.
+ * platform-specific CSRs etc.) should be saved and restored by that handler.  On
+ * cores with floating-point or vector extensions, lazy saving of floating-point
+ * and vector state may be enabled using csi_set_lazy_context_save (see that
+ * function for details).
  *
  * It is the responsibility of the user's handler to clear down the source of any
  * interrupt that it is handling, prior to returning.
@@ -38,6 +41,83 @@
  * the implementing BSP code. Typically the base trap handler implementation will
  * rely on the use of this register to store a pointer to its context space.
  *
+ * Handlers registered using csi_register_m_isr are held in a dispatch table within
+ * the M-mode context space: a directly-indexed array of csi_isr_entry_t, with one
+ * entry for each trap source enumeration (including software signals).  The base
+ * trap handler maps mcause, or the external source ID claimed from the interrupt
+ * controller, to a table index using fixed arithmetic or a constant lookup table,
+ * and then loads the handler and context from that entry.  Dispatch to a handler
+ * therefore takes a bounded number of loads, regardless of how many handlers are
+ * registered.  The table starts at an offset within mctx which is a multiple of
+ * CSI_INTERRUPT_MCTX_ALIGN, so that entries for adjacent sources share cache
+ * lines.
+ *
+ * BSPs may optionally be built with trap latency instrumentation, in which case
+ * csi_hl_bsp_interrupts.h defines the macro CSI_INTERRUPT_STATS.  The base trap
+ * handler then takes a timestamp at trap entry, immediately before calling the
+ * registered handler, immediately after it returns, and immediately before mret,
+ * and accumulates the resulting durations per source within the context space
+ * (CSI_INTERRUPT_MCTX_MIN_SIZE_BYTES includes the space required).  Timestamps are
+ * read from mcycle where implemented, otherwise from mtime; the BSP documentation
+ * states which is used.  The statistics are retrieved using csi_get_irq_stats.
+ * Without instrumentation, no timestamps are taken and csi_get_irq_stats returns
+ * CSI_NOT_IMPLEMENTED.
+ *
+ * Timed events configured using csi_set_m_timeout or csi_set_u_timeout are managed
+ * by the BSP using a hierarchical timing wheel, whose linkage is stored within the
+ * caller-owned csi_timeout_t structures rather than in the context space.  Arming
+ * and cancelling a timeout must complete in constant time.  The work done by the
+ * base timer handler is independent of the total number of timeouts currently
+ * armed: on each tick it does a constant amount of work to advance the wheel,
+ * plus, for the k timeouts falling due on that tick, the work of calling them in
+ * priority order.  Each slot keeps its timeouts in arming order, so when they
+ * share a single priority this is a constant amount per timeout; otherwise they
+ * are sorted by priority (stably, so that equal priorities keep arming order),
+ * costing O(k log k) for the tick, or O(log k) per timeout.  In addition, timeouts
+ * that are further in the future than the span of the lowest wheel level are
+ * cascaded down to finer levels as time advances.  Each cascade step moves one
+ * timeout down one level in constant time, and a timeout is only ever moved
+ * downwards, so over its lifetime a timeout is moved at most L - 1 times, where L
+ * is the number of wheel levels (fixed by the BSP).  A single tick may therefore
+ * include cascading timeouts which are not yet due, but the total handler work
+ * attributable to any one timeout, from arming to expiry or cancellation, is
+ * bounded by a constant plus its share of the priority ordering described above.
+ *
+ * The timer may be driven either by a periodic tick (configured using
+ * csi_set_timer_tick) or in tickless mode (configured using
+ * csi_set_timer_tickless).  In tickless mode the mtimecmp register is only ever
+ * programmed with the deadline of the next timeout to fall due, so a hart with no
+ * pending timeouts takes no timer interrupts.
+ *
+ * In tickless mode the timing wheel is kept, with each slot of the lowest level
+ * spanning one nominal tick (the tick_period_us passed to csi_set_timer_tickless),
+ * and each timeout held in the slot containing its deadline. There is no periodic
+ * interrupt to advance the wheel, so it is advanced lazily, to the current value
+ * of mtime, only by the timer interrupt handler; all cascade and expiry work, and
+ * all callbacks, therefore run in the timer interrupt.  Arming a timeout only
+ * inserts it into the wheel, at the level and slot given by its deadline relative
+ * to the wheel's last advance (which may place it in a coarser level than
+ * necessary, to be cascaded later), and sets mtimecmp to the new deadline if that
+ * is earlier than its current value.  Cancelling a timeout only unlinks it;
+ * mtimecmp is left unchanged, so cancelling the next timeout due may cause one
+ * timer interrupt which finds nothing to expire and reprograms mtimecmp.  Both
+ * therefore complete in constant time, whether called from M-mode or U-mode.  Each
+ * wheel level keeps a bitmap of its non-empty slots, so empty slots are skipped
+ * using a find-first-set operation rather than visited one at a time, and the
+ * advance costs a constant amount per level plus the usual cascade and expiry
+ * work.  The next expiry is found in the same way, by the timer interrupt handler
+ * after each advance: the earliest non-empty slot of the lowest level, if any,
+ * holds the next timeout to fall due; otherwise the earliest non-empty slot of the
+ * lowest non-empty coarser level gives the time at which its timeouts must be
+ * cascaded, and mtimecmp is programmed with that time, at most one extra interrupt
+ * per level being taken on the way to a deadline.  When a lowest-level slot
+ * becomes the next to fall due, the timer interrupt handler orders its timeouts by
+ * deadline, so that mtimecmp can be programmed with exact mtime resolution; this
+ * costs O(log k) per timeout, where k is the number of timeouts falling due within
+ * the same nominal tick.  A timeout armed into that slot afterwards is merged into
+ * the order by the next timer interrupt, which arming it will have brought forward
+ * if necessary.
+ *
  * Copyright (c) RISC-V International 2023. Creative Commons License. Auto-
  * generated file: DO NOT EDIT
  */
@@ -48,6 +128,87 @@
 #include "csi_types.h"
 #include "csi_hl_interrupt_sources.h"
 #include "csi_hl_bsp_interrupts.h"
+#include <stdint.h>
+
+/*
+ * Flags passed to csi_register_m_isr_ext declaring which optional register state
+ * the handler uses.  Values may be combined using bitwise OR.
+ */
+typedef enum {
+    CSI_ISR_FLAGS_NONE = 0, /* Handler uses only integer registers */
+    CSI_ISR_USES_FP = 1, /* Handler uses floating-point registers */
+    CSI_ISR_USES_VECTOR = 2, /* Handler uses vector registers */
+} csi_isr_flags_t;
+
+/*
+ * Function prototype for a deferred work function, posted using csi_post_work
+ *
+ * @param work_ctx: Context pointer that was passed into csi_post_work.
+ */
+typedef void (csi_work_fn_t)(void *work_ctx);
+
+/*
+ * Entry in the M-mode handler dispatch table held within the interrupt subsystem's
+ * context space.  isr is the registered handler (NULL if none) and isr_ctx its
+ * context pointer.  The layout is published for use by BSP code and debug tools;
+ * application code should use csi_register_m_isr rather than writing entries
+ * directly.
+ */
+typedef struct {
+    csi_isr_t *isr;
+    void *isr_ctx;
+} csi_isr_entry_t;
+
+/*
+ * Statistics for one phase of trap handling, accumulated when the BSP is built
+ * with CSI_INTERRUPT_STATS. count is the number of samples, total their sum, and
+ * min, max and mean their minimum, maximum and mean (mean is computed by
+ * csi_get_irq_stats).  hist is a log2 histogram: bin 0 counts samples of 0 or 1,
+ * and bin k (for k > 0) counts samples in the range 2^k to 2^(k+1) - 1.  Durations
+ * are in timestamp units (see notes), and saturate at 0xFFFFFFFF.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;
+    uint64_t total;
+    uint32_t hist[32];
+} csi_irq_latency_t;
+
+/*
+ * Trap handling statistics for one source, retrieved using csi_get_irq_stats.
+ * entry covers the time from trap entry to entry into the registered handler
+ * (context save and dispatch), handler the time spent within the registered
+ * handler, and exit the time from return from the registered handler to mret
+ * (context restore).
+ */
+typedef struct {
+    csi_irq_latency_t entry;
+    csi_irq_latency_t handler;
+    csi_irq_latency_t exit;
+} csi_irq_stats_t;
+
+/*
+ * Configuration of a single trap source, for use with csi_interrupts_configure.
+ * source is the enumerated trap source.  isr and isr_ctx are the M-mode handler
+ * and its context, as would be passed to csi_register_m_isr (isr may be NULL to
+ * un-register a handler).  priority and level are as would be passed to
+ * csi_set_irq_priority and csi_set_interrupt_level; a value of -1 leaves the
+ * current setting unchanged.  enable selects whether the source is enabled (as by
+ * csi_enable_m_trap_source) or disabled (as by csi_disable_m_trap_source) once
+ * configured.  An entry with a NULL isr and enable set is invalid, since it would
+ * leave the source enabled with no handler.
+ */
+typedef struct {
+    int source;
+    csi_isr_t *isr;
+    void *isr_ctx;
+    int priority;
+    int level;
+    bool enable;
+} csi_irq_config_t;
+
 
 /*
  * Initialize interrupt and timer sub-system for this hart.  Must be called before
@@ -61,10 +222,13 @@
  * the interrupt subsystem.  The BSP will define a macro
  * CSI_INTERRUPT_MCTX_MIN_SIZE_BYTES which defines the minimum required size of
  * this context space in bytes.  Calling this function initializes the context
- * space.
+ * space.  The memory must be aligned to CSI_INTERRUPT_MCTX_ALIGN bytes.
  * @param mctx_size: Size of memory allocated at the mctx pointer in bytes.
- * Allocating more than CSI_INTERRUPT_MCTX_MIN_SIZE_BYTES may permit additional
- * M-mode handlers to be registered.
+ * CSI_INTERRUPT_MCTX_MIN_SIZE_BYTES provides a dispatch table entry for each
+ * source up to CSI_TOTAL_BSP_TRAP_SOURCES.  To register handlers for software
+ * signals, allocate CSI_INTERRUPT_MCTX_SIZE_BYTES(num_sw_signals) bytes instead,
+ * which extends the dispatch table to cover signal numbers up to
+ * CSI_TOTAL_BSP_TRAP_SOURCES + num_sw_signals - 1.
  * @param mstack: Pointer to an area of memory to be used as M-mode stack space for
  * the interrupt subsystem.  This parameter may be NULL in which case the stack of
  * the interrupted thread will be used.
@@ -125,11 +289,73 @@ unsigned get_interrupts_u_handle(void);
  * the source parameter is invalid.  CSI_NOT_INITIALIZED will be returned if
  * csi_interrupts_init has not been called prior to calling this function, or if
  * csi_interrupts_uninit was called prior to calling this function.  CSI_OUT_OF_MEM
- * will be returned if the number of handlers registered exceeds that supported by
- * the context size.
+ * will be returned if the source lies beyond the end of the dispatch table
+ * supported by the context size.
  */
 csi_status_t csi_register_m_isr(void *mctx, csi_isr_t *isr, void *isr_ctx, int source);
 
+/*
+ * Registers a user-supplied M-mode handler, as csi_register_m_isr, and
+ * additionally declares whether the handler uses floating-point or vector
+ * registers.  The declaration is only used when lazy context saving has been
+ * enabled using csi_set_lazy_context_save; otherwise this function behaves
+ * identically to csi_register_m_isr.  Handlers registered using csi_register_m_isr
+ * are treated as using both floating-point and vector registers, where
+ * implemented.  This function must run in machine mode.
+ *
+ * @param mctx: M-mode context pointer previously initialised by
+ * csi_interrupts_init.
+ * @param isr: Pointer to the user's handler function; or NULL pointer to un-
+ * register a handler.
+ * @param isr_ctx: Pointer to the user's context.  This will be passed into the
+ * handler function when called.
+ * @param source: Enumerated interrupt / exception source.  This must be one of the
+ * enumerations from csi_trap_source_t, or a value from the BSP (extending the
+ * enumerations in csi_trap_source_t) enumerating a platform-specific external
+ * interrupt source.
+ * @param flags: Combination of values from csi_isr_flags_t declaring the register
+ * state used by the handler.
+ * @return : Status of ISR registration operation, as for csi_register_m_isr.
+ */
+csi_status_t csi_register_m_isr_ext(void *mctx, csi_isr_t *isr, void *isr_ctx, int source, unsigned flags);
+
+/*
+ * Configure many trap sources in a single call.  For each entry in the table, this
+ * has the same effect as calling csi_register_m_isr, csi_set_irq_priority,
+ * csi_set_interrupt_level and then csi_enable_m_trap_source or
+ * csi_disable_m_trap_source; including routing the source to this hart.  However
+ * the whole table is validated before any change is made, and controller registers
+ * are then written in a single pass, with writes to registers shared by several
+ * sources (such as interrupt controller enable words) coalesced so that each
+ * register is written at most once.  Writes are made in three phases, so that no
+ * source is ever enabled without a handler and its final priority, level and
+ * routing: first, every source whose entry disables it is disabled; second,
+ * handler table entries and priority, level and routing registers are written; and
+ * last, every source whose entry enables it is enabled.  Each handler table entry
+ * is published so that the base trap handler always sees a consistent isr and
+ * isr_ctx pair, either by writing the pair with a single store or by writing
+ * isr_ctx before isr (with a fence between them where the hart's memory ordering
+ * requires it).  Sources which are enabled both before and after the call are not
+ * disabled, so an interrupt from such a source whose handler is being replaced is
+ * handled by either the old handler with its old context or the new handler with
+ * its new context.  This function must run in machine mode.
+ *
+ * If the same source appears more than once in the table, the last entry takes
+ * effect.
+ *
+ * @param mctx: M-mode context pointer previously initialised by
+ * csi_interrupts_init.
+ * @param table: Array of source configurations.
+ * @param n: Number of entries in table.
+ * @return : Status of configuration operation.  CSI_ERROR will be returned if any
+ * entry is invalid, in which case no change will have been made.
+ * CSI_NOT_INITIALIZED will be returned if csi_interrupts_init has not been called
+ * prior to calling this function.  CSI_OUT_OF_MEM will be returned if any source
+ * lies beyond the end of the dispatch table supported by the context size, in
+ * which case no change will have been made.
+ */
+csi_status_t csi_interrupts_configure(void *mctx, const csi_irq_config_t *table, unsigned n);
+
 /*
  * Registers a user-supplied function (isr) that will be called in U-mode by the
  * base trap handler on receipt of a trap arising from from the source signal.
@@ -264,6 +490,17 @@ csi_status_t csi_set_umode_trap_permissions(void *mctx, int source, bool permitt
  * raised, the signal will be routed to the specified hart ID.  Must be run in
  * machine mode.
  *
+ * All software signals routed to a hart, including multicast signals, the signal
+ * used by the deferred work queue and the doorbell of the inter-hart messaging
+ * module, share the hart's single machine software interrupt (its MSIP bit).  Each
+ * signal therefore has its own pending flag in the target hart's context space.
+ * Raising a signal sets its flag atomically and then sets MSIP.  On a software
+ * interrupt, the base trap handler clears MSIP first and then dispatches the
+ * handler of every signal whose flag is set, clearing each flag atomically before
+ * calling its handler, so a signal raised during dispatch sets MSIP again and is
+ * not lost.  MSIP is only ever cleared by the base trap handler before it scans
+ * the flags, or as described for csi_wait_sw_signal_acks.
+ *
  * @param mctx: M-mode context pointer previously initialised by
  * csi_interrupts_init.
  * @param signal: Source enumeration for this signal.  A unique number >=
@@ -286,6 +523,86 @@ csi_status_t csi_define_sw_signal(void *mctx, int signal, int hartid);
  */
 csi_status_t csi_raise_m_sw_signal(void *mctx, int signal);
 
+/*
+ * Allocates a signal number for software use which may be raised on several harts
+ * at once using csi_raise_m_sw_signal_multicast.  Unlike csi_define_sw_signal,
+ * this function is run on each hart that is to receive the signal (and on any hart
+ * that will raise it), passing the same multicast object each time.  The signal
+ * number must be outside the range currently reserved by the BSP, otherwise an
+ * error is raised.  A receiving hart registers its handler for the signal using
+ * csi_register_m_isr in the usual way.  Must be run in machine mode.
+ *
+ * @param mctx: M-mode context pointer for the calling hart, previously initialised
+ * by csi_interrupts_init.
+ * @param signal: Source enumeration for this signal.  A unique number >=
+ * CSI_TOTAL_BSP_TRAP_SOURCES must be chosen.
+ * @param mcast: Multicast object shared by all harts using this signal.  The
+ * structure declaration csi_sw_multicast_t is published by the BSP in
+ * csi_hl_bsp_interrupts.h but should be considered private to the BSP.
+ * Application code instantiates this structure, in memory accessible to all
+ * participating harts, and passes in a pointer to it.  It holds the set of harts
+ * which have yet to acknowledge the most recent raise.
+ * @return : Status of operation.  CSI_ERROR will be returned if the signal
+ * parameter is invalid.
+ */
+csi_status_t csi_define_multicast_sw_signal(void *mctx, int signal, csi_sw_multicast_t *mcast);
+
+/*
+ * Raises a multicast software signal, previously defined using
+ * csi_define_multicast_sw_signal, on a set of harts.  The set of target harts is
+ * recorded in the signal's multicast object as awaiting acknowledgement, and the
+ * machine software interrupt of each target hart is then raised, in a single pass
+ * over the CLINT / ACLINT software interrupt registers.  The function returns
+ * without waiting for the targets to respond; use csi_wait_sw_signal_acks to wait.
+ * On each target hart, the base trap handler acknowledges the signal automatically
+ * when the registered handler returns.  Must be run in machine mode.
+ *
+ * @param mctx: M-mode context pointer for the calling hart, previously initialised
+ * by csi_interrupts_init.
+ * @param signal: Source enumeration for this signal.
+ * @param hart_mask: Bit mask of target harts: bit n selects hart hart_mask_base +
+ * n.  The calling hart may be included; it acknowledges the signal when its
+ * handler returns, or when it calls csi_wait_sw_signal_acks.
+ * @param hart_mask_base: ID of the hart corresponding to bit 0 of hart_mask; or
+ * -1UL to select all harts on which the signal has been defined, in which case
+ * hart_mask is ignored.
+ * @return : Status of operation.  CSI_ERROR will be returned if the signal has not
+ * been defined using csi_define_multicast_sw_signal, or if the mask selects a hart
+ * on which it has not been defined.  CSI_BUSY will be returned if acknowledgements
+ * for a previous raise of this signal are still outstanding.
+ */
+csi_status_t csi_raise_m_sw_signal_multicast(void *mctx, int signal, unsigned long hart_mask, unsigned long hart_mask_base);
+
+/*
+ * Wait until all harts targeted by the most recent call to
+ * csi_raise_m_sw_signal_multicast for this signal have acknowledged it, i.e. their
+ * handlers have run and returned.  If the calling hart is itself a target and has
+ * not yet acknowledged the signal, this function first services it inline: it
+ * clears the signal's pending flag on the calling hart (see csi_define_sw_signal),
+ * calls the registered handler directly and acknowledges, just as the base trap
+ * handler would.  The calling hart's MSIP bit is left set if any other software
+ * signal, work queue wakeup or inter-hart messaging doorbell is pending on it.
+ * Otherwise MSIP is cleared and the pending flags are checked again afterwards,
+ * MSIP being set again if one was raised in the meantime, so no other wakeup is
+ * lost.  The wait therefore completes even when called with interrupts masked, or
+ * from another handler.  It must not be called from the handler of the same
+ * signal.  While waiting for other harts, this function polls the multicast
+ * object, repeatedly calling wait_fn.  Must be run in machine mode.
+ *
+ * @param mctx: M-mode context pointer for the calling hart, previously initialised
+ * by csi_interrupts_init.
+ * @param signal: Source enumeration for this signal.
+ * @param wait_fn: Pointer to a function to be called between polls; may be NULL to
+ * busy-wait.
+ * @param timeout_us: Maximum time to wait in microseconds, or 0 to wait
+ * indefinitely.
+ * @return : Status of operation.  CSI_TIMEOUT will be returned if not all target
+ * harts acknowledged within the timeout. CSI_ERROR will be returned if the signal
+ * has not been defined using csi_define_multicast_sw_signal, or if this function
+ * is called from the handler of the same signal.
+ */
+csi_status_t csi_wait_sw_signal_acks(void *mctx, int signal, csi_poll_wait_wrapper_t *wait_fn, unsigned timeout_us);
+
 /*
  * Raises a software signal, previously defined using csi_define_sw_signal.  Must
  * be run in user mode. User-mode permissions for the selected signal must have
@@ -525,12 +842,175 @@ csi_status_t csi_register_fast_exception_handler(void *mctx, void *handler);
  */
 csi_status_t csi_set_preemption(void *mctx, bool preemption_enabled);
 
+/*
+ * Enable or disable tail-chaining in the base trap handler.  When enabled, after a
+ * registered handler returns and before restoring register context, the base trap
+ * handler checks the interrupt controller for any further pending and enabled
+ * interrupt which the hart would take immediately after mret.  No interrupt is
+ * chained unless the interrupted context had interrupts enabled (mstatus.MPIE
+ * set), since otherwise mret returns with interrupts disabled.  Where interrupt
+ * levels are supported (CSI_MAX_INTERRUPT_LEVEL greater than 0), the interrupt's
+ * level must be strictly greater than both the level of the interrupted context (0
+ * for code outside any handler) and the level threshold (see
+ * csi_get_interrupt_level_thresh), and its priority must be at or above the
+ * priority threshold (see csi_set_irq_priority_thresh); a pending interrupt which
+ * would have to wait for a preempted lower-level handler to complete is therefore
+ * never chained ahead of it.  Where interrupt levels are not supported
+ * (CSI_MAX_INTERRUPT_LEVEL is 0, as with the CLINT and PLIC), any pending and
+ * enabled interrupt whose priority is at or above the priority threshold is
+ * chained.  If one is found, it is claimed and its handler is dispatched
+ * immediately, without restoring and re-saving register context or executing mret.
+ * This is repeated until no such interrupt is pending, at which point context is
+ * restored and mret executed as normal.  Interrupts are selected in the same order
+ * (by level, then priority) as the hardware would have taken them.  Where
+ * preemption is enabled (see csi_set_preemption), a higher-level interrupt
+ * arriving during a chained handler preempts it in the normal way.  This function
+ * must be run in machine mode.
+ *
+ * If trap latency instrumentation is enabled (see csi_get_irq_stats), the entry
+ * time of a chained handler is measured from the return of the previous handler,
+ * and its exit time up to the start of the next chained handler or mret.
+ *
+ * @param mctx: M-mode context pointer previously initialised by
+ * csi_interrupts_init.
+ * @param tail_chaining_enabled: Set true to enable tail-chaining, false to
+ * disable.
+ * @return : Status of operation.  CSI_NOT_IMPLEMENTED will be returned if the BSP
+ * does not support tail-chaining.
+ */
+csi_status_t csi_set_tail_chaining(void *mctx, bool tail_chaining_enabled);
+
+/*
+ * Retrieve trap handling statistics for a source, accumulated by the base trap
+ * handler since initialization or since the last call to csi_clear_irq_stats for
+ * that source.  Only available if the BSP was built with trap latency
+ * instrumentation (indicated by the macro CSI_INTERRUPT_STATS).  Must be run in
+ * machine mode.
+ *
+ * @param mctx: M-mode context pointer previously initialised by
+ * csi_interrupts_init.
+ * @param source: Enumerated interrupt / exception source.
+ * @param stats: Pointer to structure to be filled with the statistics for this
+ * source.
+ * @return : Status of operation.  CSI_ERROR will be returned if the source
+ * parameter is invalid.  CSI_NOT_IMPLEMENTED will be returned if the BSP was built
+ * without trap latency instrumentation.
+ */
+csi_status_t csi_get_irq_stats(void *mctx, int source, csi_irq_stats_t *stats);
+
+/*
+ * Reset the trap handling statistics for a source, or for all sources.  Must be
+ * run in machine mode.
+ *
+ * @param mctx: M-mode context pointer previously initialised by
+ * csi_interrupts_init.
+ * @param source: Enumerated interrupt / exception source, or -1 to reset
+ * statistics for all sources.
+ * @return : Status of operation.  CSI_ERROR will be returned if the source
+ * parameter is invalid.  CSI_NOT_IMPLEMENTED will be returned if the BSP was built
+ * without trap latency instrumentation.
+ */
+csi_status_t csi_clear_irq_stats(void *mctx, int source);
+
+/*
+ * Enable or disable lazy saving of floating-point and vector register state by the
+ * base trap handler.  When disabled (the default), floating-point and vector state
+ * is saved and restored around every handler, where implemented.  When enabled,
+ * the base trap handler saves only integer register state on trap entry. Floating-
+ * point (or vector) state is then only saved if the handler about to run was
+ * declared with CSI_ISR_USES_FP (or CSI_ISR_USES_VECTOR) using
+ * csi_register_m_isr_ext, and the mstatus.FS (or mstatus.VS) field of the
+ * interrupted context shows that it holds live state (Dirty or Clean).  If the
+ * field is Initial, the registers are reset to their initial values on exit
+ * instead of being restored, and if it is Off nothing is saved.  The interrupted
+ * context's FS and VS fields are restored before mret.  While a handler that has
+ * not declared the use of floating-point (or vector) state is running, mstatus.FS
+ * (or mstatus.VS) is set to Off, so that any accidental use raises an illegal
+ * instruction exception rather than corrupting the interrupted context.  This
+ * function must be run in machine mode.
+ *
+ * @param mctx: M-mode context pointer previously initialised by
+ * csi_interrupts_init.
+ * @param lazy_save_enabled: Set true to enable lazy saving, false to disable.
+ * @return : Status of operation.  CSI_NOT_IMPLEMENTED will be returned if the core
+ * implements neither floating-point nor vector registers, or the BSP does not
+ * support lazy saving.
+ */
+csi_status_t csi_set_lazy_context_save(void *mctx, bool lazy_save_enabled);
+
+/*
+ * Initialize the deferred work queue for this hart.  Deferred work allows a
+ * handler to post a function to be run later, at a lower interrupt level, so that
+ * long-running work does not block other interrupts at the handler's level.  Work
+ * items posted with csi_post_work are appended to a lock-free multiple-producer
+ * single-consumer queue held in this hart's context space, and run by a handler
+ * for the software signal given here, which this function registers and enables at
+ * the given interrupt level.  The signal must previously have been defined using
+ * csi_define_sw_signal and routed to this hart.  This function must be run in
+ * machine mode.
+ *
+ * Where interrupt levels are not supported (CSI_MAX_INTERRUPT_LEVEL is 0, as with
+ * the CLINT and PLIC), level must be 0, and work is instead run with interrupts
+ * enabled: the handler for the signal clears mie.MSIE, so that it cannot be re-
+ * entered, and sets mstatus.MIE before running the queued items, having saved mepc
+ * and mstatus on its stack.  Once the queue is empty it disables interrupts again,
+ * restores mie.MSIE and the saved CSRs, and returns.  While work runs, external
+ * and timer interrupts are therefore taken as normal, but other software
+ * interrupts on the hart (other software signals and IPI doorbells) are held
+ * pending until the queue is empty.
+ *
+ * @param mctx: M-mode context pointer previously initialised by
+ * csi_interrupts_init.
+ * @param signal: Software signal used to trigger processing of the queue.
+ * @param level: Interrupt level at which queued work is run (see
+ * csi_set_interrupt_level).  This should be lower than the level of any handler
+ * that posts work.  Must be 0 where interrupt levels are not supported (see the
+ * notes above).
+ * @return : Status of operation.  CSI_ERROR will be returned if the signal is
+ * invalid or not routed to this hart, or if level is out of range.
+ * CSI_NOT_IMPLEMENTED will be returned if level is non-zero and interrupt levels
+ * are not supported.
+ */
+csi_status_t csi_work_queue_init(void *mctx, int signal, int level);
+
+/*
+ * Post a deferred work item to a hart's work queue, to be run at the level set by
+ * csi_work_queue_init.  The item is appended to the queue with a single atomic
+ * exchange, without locks or disabling interrupts, so this function may be called
+ * from handlers at any level and from any hart.  The software signal is only
+ * raised when the item is added to an empty queue; items posted while the signal
+ * is already pending or the queue is being run are picked up by the same pass, so
+ * a burst of posts costs a single software interrupt.  Items are run in the order
+ * in which they were posted, and each item is removed from the queue before its
+ * function is called, so the function may re-post it.  This function may be run in
+ * machine mode only.
+ *
+ * @param mctx: M-mode context pointer of the hart on which the work is to be run,
+ * previously initialised by csi_interrupts_init and csi_work_queue_init.
+ * @param work: Work item handle.  The structure declaration csi_work_t is
+ * published by the BSP in csi_hl_bsp_interrupts.h but should be considered private
+ * to the BSP.  Application code instantiates this structure and passes in a
+ * pointer to it.  The structure holds the queue linkage, so it must remain
+ * allocated until the work function has been called.
+ * @param fn: Pointer to the work function.
+ * @param work_ctx: Pointer to the user's context, which will be passed into the
+ * work function.
+ * @return : Status of operation.  CSI_BUSY will be returned if the work item is
+ * already queued.  CSI_NOT_INITIALIZED will be returned if csi_work_queue_init has
+ * not been run for the target hart.
+ */
+csi_status_t csi_post_work(void *mctx, csi_work_t *work, csi_work_fn_t *fn, void *work_ctx);
+
 /*
  * This function causes the BSP to register a base handler for timer interrupts and
  * to control the value of the mtimecmp register in order to produce a regular
  * timer tick interrupt at the requested frequency.   This base timer handler can
- * then service multiple timed events that may be configured using csi_set_timeout.
- * This function must be run in machine mode.
+ * then service multiple timed events that may be configured using
+ * csi_set_m_timeout or csi_set_u_timeout.  On each tick, the base timer handler
+ * advances the timing wheel by one slot, cascades any timeouts from coarser wheel
+ * levels whose slot has been reached, and runs the callbacks for timeouts which
+ * have fallen due, with the cost bounds given in the notes above.  This function
+ * must be run in machine mode.
  *
  * @param mctx: M-mode context pointer previously initialised by
  * csi_interrupts_init.
@@ -543,28 +1023,64 @@ csi_status_t csi_set_preemption(void *mctx, bool preemption_enabled);
  */
 csi_status_t csi_set_timer_tick(void *mctx, unsigned tick_period_us);
 
+/*
+ * This function is an alternative to csi_set_timer_tick.  It causes the BSP to
+ * register a base handler for timer interrupts, but rather than producing a
+ * regular tick, the BSP programs mtimecmp with the deadline of the earliest
+ * pending timeout.  The timer interrupt handler reprograms it each time it runs,
+ * and it is brought forward when an earlier deadline is armed by
+ * csi_set_m_timeout, csi_set_u_timeout, csi_set_m_deadline or csi_set_u_deadline;
+ * csi_cancel_timeout leaves it unchanged.  When no timeouts are pending, mtimecmp
+ * is set to its maximum value so that no timer interrupts are taken.  Deadlines
+ * set using csi_set_m_deadline or csi_set_u_deadline expire with the resolution of
+ * mtime.  The timing wheel is advanced, and the earliest pending deadline found,
+ * only by the timer interrupt handler, as described in the notes above.  This
+ * function must be run in machine mode.
+ *
+ * @param mctx: M-mode context pointer previously initialised by
+ * csi_interrupts_init.
+ * @param tick_period_us: Nominal tick period in microseconds.  No periodic
+ * interrupt is generated; this value is used to convert the timeout_ticks
+ * parameter of csi_set_m_timeout and csi_set_u_timeout into a deadline in mtime
+ * units, and as the span of a slot in the lowest level of the timing wheel.
+ * Passing a value of 0 turns off timer interrupts.
+ * @return : Status of operation.  CSI_ERROR will be returned if the request is
+ * invalid.  CSI_NOT_IMPLEMENTED will be returned if the BSP does not support
+ * tickless operation.
+ */
+csi_status_t csi_set_timer_tickless(void *mctx, unsigned tick_period_us);
+
 /*
  * Registers a callback function (callback) which will be called after a period set
  * by timeout_ticks unless cancelled with cs_cancel_timeout().  callback_context
  * will be passed into the user's callback function.  The structure pointed to by
  * timeout_handle will be initialised by this function and used as a handle for
- * this timeout instance.  This function must be run in machine mode.
+ * this timeout instance.  The timeout is inserted into the BSP's timing wheel in
+ * constant time, independent of the number of timeouts already armed.  This
+ * function must be run in machine mode.
  *
  * @param mctx: M-mode context pointer previously initialised by
  * csi_interrupts_init.
  * @param timeout_handle: Handle for this timeout instance.  The structure
  * declaration csi_timeout_t is published by the BSP in csi_hl_bsp_interrupts.h but
  * should be considered private to the BSP.  Application code instantiates this
- * structure and passes in a pointer to it.
+ * structure and passes in a pointer to it.  The structure holds the timing wheel
+ * linkage for this timeout, so it must remain allocated until the timeout has
+ * expired or been cancelled. Passing a handle for a timeout which is still armed
+ * re-arms it with the new parameters.
  * @param callback: Pointer to the users callback function, to be called when the
  * timeout expires.
  * @param callback_context: Pointer to the user's context space, which will be
  * passed into the callback function.
- * @param timeout_ticks: Timeout period in ticks (configured by csi_set_timer_tick)
+ * @param timeout_ticks: Timeout period in ticks (configured by csi_set_timer_tick
+ * or csi_set_timer_tickless)
  * @param priority: Priority for this timeout, used to determine the callback to be
  * called if two callbacks fall due on the same timer tick.  Higher numbers
  * indicate higher priority.  A single priority scheme is shared between M-mode and
- * U-mode callbacks.
+ * U-mode callbacks.  Callbacks of equal priority falling due on the same tick are
+ * called in the order in which they were armed.  Ordering k callbacks of differing
+ * priorities which fall due on the same tick costs O(k log k) in the timer
+ * handler.
  * @return : Status of operation.
  */
 csi_status_t csi_set_m_timeout(void *mctx, csi_timeout_t *timeout_handle, csi_timeout_callback_t *callback, void *callback_context, int timeout_ticks, int priority);
@@ -574,34 +1090,109 @@ csi_status_t csi_set_m_timeout(void *mctx, csi_timeout_t *timeout_handle, csi_ti
  * by timeout_ticks unless cancelled with cs_cancel_timeout().  callback_context
  * will be passed into the user's callback function.  The structure pointed to by
  * timeout_handle will be initialised by this function and used as a handle for
- * this timeout instance.  This function must be run in user mode.
+ * this timeout instance.  The timeout is inserted into the BSP's timing wheel in
+ * constant time, independent of the number of timeouts already armed.  This
+ * function must be run in user mode.
  *
  * @param irq_system_handle: Handle for the interrupt sub-system on this hart,
  * obtained by running get_interrupts_u_handle
  * @param timeout_handle: Handle for this timeout instance.  The structure
  * declaration csi_timeout_t is published by the BSP in csi_hl_bsp_interrupts.h but
  * should be considered private to the BSP.  Application code instantiates this
- * structure and passes in a pointer to it.
+ * structure and passes in a pointer to it.  The structure holds the timing wheel
+ * linkage for this timeout, so it must remain allocated until the timeout has
+ * expired or been cancelled. Passing a handle for a timeout which is still armed
+ * re-arms it with the new parameters.
  * @param callback: Pointer to the users callback function, to be called when the
  * timeout expires.
  * @param callback_context: Pointer to the user's context space, which will be
  * passed into the callback function.
- * @param timeout_ticks: Timeout period in ticks (configured by csi_set_timer_tick)
+ * @param timeout_ticks: Timeout period in ticks (configured by csi_set_timer_tick
+ * or csi_set_timer_tickless)
  * @param priority: Priority for this timeout, used to determine the callback to be
  * called if two callbacks fall due on the same timer tick.  Higher numbers
  * indicate higher priority.  A single priority scheme is shared between M-mode and
- * U-mode callbacks.
+ * U-mode callbacks.  Callbacks of equal priority falling due on the same tick are
+ * called in the order in which they were armed.  Ordering k callbacks of differing
+ * priorities which fall due on the same tick costs O(k log k) in the timer
+ * handler.
  * @return : Status of operation.
  */
 csi_status_t csi_set_u_timeout(unsigned irq_system_handle, csi_timeout_t *timeout_handle, csi_timeout_callback_t *callback, void *callback_context, int timeout_ticks, int priority);
 
 /*
- * Cancels a timeout previously configured with csi_set_timeout, using the
- * associated handle. Cancelling a timer that has already expired is not an error.
- * This function may be run in either machine mode or user mode.
+ * Registers a callback function (callback) which will be called when the system
+ * timer reaches an absolute deadline, unless cancelled with csi_cancel_timeout.
+ * The deadline is expressed in the same units as the value returned by
+ * csi_read_mtime.  callback_context will be passed into the user's callback
+ * function.  The structure pointed to by timeout_handle will be initialised by
+ * this function and used as a handle for this timeout instance.  If the timer is
+ * running in tickless mode (see csi_set_timer_tickless), the callback is called as
+ * soon as mtime reaches the deadline; otherwise it is called on the first timer
+ * tick at or after the deadline.  A deadline which has already passed expires in
+ * the next timer interrupt, which in tickless mode is taken immediately; the
+ * callback is never called from within this function.  This function must be run
+ * in machine mode.
+ *
+ * @param mctx: M-mode context pointer previously initialised by
+ * csi_interrupts_init.
+ * @param timeout_handle: Handle for this timeout instance.  The structure
+ * declaration csi_timeout_t is published by the BSP in csi_hl_bsp_interrupts.h but
+ * should be considered private to the BSP.  Application code instantiates this
+ * structure and passes in a pointer to it.  The structure must remain allocated
+ * until the timeout has expired or been cancelled.
+ * @param callback: Pointer to the users callback function, to be called when the
+ * deadline is reached.
+ * @param callback_context: Pointer to the user's context space, which will be
+ * passed into the callback function.
+ * @param deadline_mtime: Absolute deadline, in mtime units (see csi_read_mtime).
+ * @param priority: Priority for this timeout, used to determine the callback to be
+ * called first if two callbacks fall due at the same time.  Higher numbers
+ * indicate higher priority.  A single priority scheme is shared between M-mode and
+ * U-mode callbacks, and between tick-based and deadline-based timeouts.
+ * @return : Status of operation.  CSI_ERROR will be returned if the timer has not
+ * been configured using csi_set_timer_tick or csi_set_timer_tickless.
+ */
+csi_status_t csi_set_m_deadline(void *mctx, csi_timeout_t *timeout_handle, csi_timeout_callback_t *callback, void *callback_context, uint64_t deadline_mtime, int priority);
+
+/*
+ * Registers a callback function (callback) which will be called when the system
+ * timer reaches an absolute deadline, unless cancelled with csi_cancel_timeout.
+ * Behaviour is as for csi_set_m_deadline, except that this function must be run in
+ * user mode.
+ *
+ * @param irq_system_handle: Handle for the interrupt sub-system on this hart,
+ * obtained by running get_interrupts_u_handle
+ * @param timeout_handle: Handle for this timeout instance.  The structure
+ * declaration csi_timeout_t is published by the BSP in csi_hl_bsp_interrupts.h but
+ * should be considered private to the BSP.  Application code instantiates this
+ * structure and passes in a pointer to it.  The structure must remain allocated
+ * until the timeout has expired or been cancelled.
+ * @param callback: Pointer to the users callback function, to be called when the
+ * deadline is reached.
+ * @param callback_context: Pointer to the user's context space, which will be
+ * passed into the callback function.
+ * @param deadline_mtime: Absolute deadline, in mtime units (see csi_read_mtime).
+ * @param priority: Priority for this timeout, used to determine the callback to be
+ * called first if two callbacks fall due at the same time.  Higher numbers
+ * indicate higher priority.  A single priority scheme is shared between M-mode and
+ * U-mode callbacks, and between tick-based and deadline-based timeouts.
+ * @return : Status of operation.  CSI_ERROR will be returned if the timer has not
+ * been configured using csi_set_timer_tick or csi_set_timer_tickless.
+ */
+csi_status_t csi_set_u_deadline(unsigned irq_system_handle, csi_timeout_t *timeout_handle, csi_timeout_callback_t *callback, void *callback_context, uint64_t deadline_mtime, int priority);
+
+/*
+ * Cancels a timeout previously configured with csi_set_m_timeout,
+ * csi_set_u_timeout, csi_set_m_deadline or csi_set_u_deadline, using the
+ * associated handle.  The timeout is unlinked from the timing wheel in constant
+ * time; no other timing wheel work is done, and no callback is called.  Cancelling
+ * a timer that has already expired is not an error.  This function may be run in
+ * either machine mode or user mode.
  *
  * @param timeout_handle: handle for this timeout instance, previously initialised
- * with csi_set_timeout
+ * with csi_set_m_timeout, csi_set_u_timeout, csi_set_m_deadline or
+ * csi_set_u_deadline
  * @return : Status of operation.
  */
 csi_status_t csi_cancel_timeout(csi_timeout_t *timeout_handle);
@@ -0,0 +1,165 @@
+/*
+ * High-Level Inter-Hart Messaging
+ *
+ * This module provides lightweight message passing between harts.  Messages are
+ * passed through single-producer / single-consumer rings, one for each ordered
+ * pair of harts, held in a context space supplied by the caller and shared by all
+ * participating harts.  Because each ring has exactly one writer and one reader,
+ * no locks are required.  A receiving hart is notified by a doorbell (its machine
+ * software interrupt); doorbells are coalesced, so a burst of messages to a hart
+ * raises at most one interrupt, and the receiver is passed all waiting messages
+ * from a given sender as a single batch.
+ *
+ * This module requires the RVM-CSI high-level interrupt and timer module to be
+ * initialized on each receiving hart. The BSP's base trap handler shares the
+ * machine software interrupt between this module and software signals defined
+ * using csi_define_sw_signal; the doorbell has its own pending flag alongside
+ * those of the signals, as described for csi_define_sw_signal, and a sender sets
+ * it before raising the destination hart's MSIP bit.
+ *
+ * Each ring carries a doorbell flag.  A sender raises the destination hart's
+ * doorbell only if it changes this flag from clear to set; the receiver clears the
+ * flag before emptying the ring, and checks the ring again afterwards, so no
+ * message can be left unnoticed.
+ *
+ * Messages from a single sender to a single receiver are delivered in order.  No
+ * ordering is guaranteed between messages from different senders.
+ *
+ * Each ring has one producer and one consumer only in the sense of one hart at
+ * each end; on each hart, several contexts may use the same end.  A sending hart
+ * may call csi_ipi_send or csi_ipi_send_batch to the same destination both from
+ * thread code and from interrupt handlers, so these functions clear mstatus.MIE
+ * for the duration of the ring update (reserving slots, copying messages and
+ * publishing the new head), making updates from the same hart atomic with respect
+ * to one another; the doorbell is raised after interrupts are restored. On the
+ * receiving side, the doorbell handler and csi_ipi_poll claim the hart's receive
+ * side before emptying any ring, by testing and setting a per-hart flag with
+ * interrupts disabled.  A call which finds the receive side already claimed (for
+ * example csi_ipi_poll called from an interrupt handler which preempted the
+ * doorbell handler, or the doorbell handler interrupting csi_ipi_poll) returns at
+ * once without delivering anything. The holder rescans all rings before releasing
+ * the claim, so messages which arrived in the meantime are still delivered.
+ * Callbacks therefore never run concurrently on one hart, and may run with
+ * interrupts enabled.
+ *
+ * Copyright (c) RISC-V International 2023. Creative Commons License. Auto-
+ * generated file: DO NOT EDIT
+ */
+
+#ifndef CSI_HL_IPI_H
+#define CSI_HL_IPI_H
+
+#include "csi_types.h"
+#include "csi_ll_bsp_defs.h"
+
+/*
+ * A message passed between harts.  The meaning of tag and data is defined by the
+ * application; for example tag may select an operation and data carry its argument
+ * or a pointer to a larger payload in shared memory.
+ */
+typedef struct {
+    unsigned long tag;
+    unsigned long data;
+} csi_ipi_msg_t;
+
+/*
+ * Function prototype for the user's message handler, called in M-mode on the
+ * receiving hart from the machine software interrupt handler.
+ *
+ * @param callback_ctx: Context pointer that was passed into csi_ipi_attach.
+ * @param src_hartid: ID of the hart which sent the messages.
+ * @param msgs: Messages received from src_hartid, in the order sent.  The array is
+ * only valid for the duration of the call.
+ * @param count: Number of messages in the msgs array.
+ */
+typedef void (csi_ipi_batch_callback_t)(void *callback_ctx, int src_hartid, const csi_ipi_msg_t *msgs, unsigned count);
+
+
+/*
+ * Initialize the messaging context space.  This function must be run once, on one
+ * hart, before any hart calls any other function in this module.  The BSP defines
+ * a macro CSI_IPI_CTX_SIZE_BYTES(num_harts, ring_entries) in csi_ll_bsp_defs.h
+ * giving the required size of the context space.  Must be run in machine mode.
+ *
+ * @param ipi_ctx: Pointer to memory shared by all participating harts, to be used
+ * as context space for this module.
+ * @param ctx_size: Size of memory allocated at the ipi_ctx pointer in bytes.
+ * @param num_harts: Number of participating harts.  Hart IDs 0 to num_harts - 1
+ * are supported.
+ * @param ring_entries: Number of messages which each ring can hold.  Must be a
+ * power of two.
+ * @return : Status of initialisation operation.  CSI_OUT_OF_MEM will be returned
+ * if ctx_size is less than CSI_IPI_CTX_SIZE_BYTES(num_harts, ring_entries).
+ * CSI_ERROR will be returned if ring_entries is not a power of two.
+ */
+csi_status_t csi_ipi_init(void *ipi_ctx, unsigned ctx_size, unsigned num_harts, unsigned ring_entries);
+
+/*
+ * Register the calling hart to receive messages, and enable its doorbell
+ * interrupt.  Messages sent to a hart before it has attached are held in the rings
+ * and delivered once it attaches.  Passing a NULL callback detaches the hart;
+ * messages then remain in the rings until the hart attaches again.  Must be run in
+ * machine mode.
+ *
+ * @param ipi_ctx: Context space previously initialised by csi_ipi_init.
+ * @param mctx: M-mode interrupt subsystem context pointer for the calling hart,
+ * previously initialised by csi_interrupts_init.
+ * @param callback: User's message handler; or NULL to detach.
+ * @param callback_ctx: User's context pointer which will be passed into the
+ * callback function when it is run.
+ * @return : Status of operation.  CSI_ERROR will be returned if the calling hart's
+ * ID is not below the num_harts value passed to csi_ipi_init.
+ */
+csi_status_t csi_ipi_attach(void *ipi_ctx, void *mctx, csi_ipi_batch_callback_t *callback, void *callback_ctx);
+
+/*
+ * Send a message from the calling hart to another hart.  The message is copied
+ * into the ring for this pair of harts, and the destination hart's doorbell is
+ * raised unless it has already been raised for this ring and not yet serviced.
+ * This function does not block.  It may be called from thread code and from
+ * interrupt handlers on the same hart, as described in the notes above.  Must be
+ * run in machine mode.
+ *
+ * @param ipi_ctx: Context space previously initialised by csi_ipi_init.
+ * @param dest_hartid: ID of the destination hart.  Must differ from the calling
+ * hart's ID.
+ * @param msg: Message to send.
+ * @return : Status of operation.  CSI_BUSY will be returned if the ring to the
+ * destination hart is full, in which case the message is not sent.  CSI_ERROR will
+ * be returned if dest_hartid is invalid.
+ */
+csi_status_t csi_ipi_send(void *ipi_ctx, int dest_hartid, const csi_ipi_msg_t *msg);
+
+/*
+ * Send several messages from the calling hart to another hart.  The messages are
+ * copied into the ring for this pair of harts and published together, and the
+ * destination hart's doorbell is raised at most once.  This function does not
+ * block; if the ring does not have space for all the messages, as many as fit are
+ * sent.  Must be run in machine mode.
+ *
+ * @param ipi_ctx: Context space previously initialised by csi_ipi_init.
+ * @param dest_hartid: ID of the destination hart.  Must differ from the calling
+ * hart's ID.
+ * @param msgs: Messages to send, in order.
+ * @param count: Number of messages in the msgs array.
+ * @return : Number of messages sent, or an error code from csi_status_t (CSI_ERROR
+ * if dest_hartid is invalid).
+ */
+long csi_ipi_send_batch(void *ipi_ctx, int dest_hartid, const csi_ipi_msg_t *msgs, unsigned count);
+
+/*
+ * Deliver any messages waiting for the calling hart, by calling its registered
+ * callback, without waiting for the doorbell interrupt.  This may be used by harts
+ * which run with interrupts disabled.  It may be called from any context; if the
+ * hart's receive side is already claimed (see the notes above), including when
+ * called from a csi_ipi_batch_callback_t, it returns 0 and the messages are
+ * delivered by the holder.  Must be run in machine mode.
+ *
+ * @param ipi_ctx: Context space previously initialised by csi_ipi_init.
+ * @return : Number of messages delivered, or an error code from csi_status_t
+ * (CSI_NOT_INITIALIZED if the calling hart has not attached).
+ */
+long csi_ipi_poll(void *ipi_ctx);
+
+
+#endif /* CSI_HL_IPI_H */ 
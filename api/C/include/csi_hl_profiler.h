@@ -0,0 +1,156 @@
+/*
+ * High-Level Sampling Profiler
+ *
+ * This module provides a statistical profiler which needs no debugger.  At a
+ * regular interval, either every N timer ticks or every N occurrences of a
+ * hardware performance monitor event, the interrupted program counter (mepc), and
+ * optionally the return address register, are recorded into a ring of samples in
+ * memory supplied by the caller.  Each hart profiles into its own ring, so no
+ * locking is required.  The rings use a fixed layout which is independent of XLEN,
+ * so that they can be read from a memory dump and symbolized on a host against the
+ * ELF file of the application, giving a flat profile or folded stacks for flame
+ * graph tools.
+ *
+ * A ring consists of a csi_profiler_ring_hdr_t header, followed immediately by an
+ * array of csi_profiler_sample_t. The header's write_idx is incremented after each
+ * sample is written; a sample's slot is write_idx modulo num_samples.  When the
+ * ring is full, the oldest samples are overwritten, so that the ring always holds
+ * the most recent samples.  A reader wishing to take a consistent copy of a
+ * running ring should read write_idx before and after copying, and discard any
+ * samples which may have been overwritten in between.
+ *
+ * When the source is CSI_PROFILER_SOURCE_HPM, the chosen counter is configured
+ * (using the Sscofpmf extension) to raise a local counter overflow interrupt after
+ * every period events, and this module registers its handler for
+ * CSI_ENUM_COUNTER_OVERFLOW_INTERRUPT using csi_register_m_isr.  The event counted
+ * is the one previously selected using csi_hpm_set_event, or cycles if the counter
+ * is CSI_HPM_CYCLE.  CSI_NOT_IMPLEMENTED is returned on harts without Sscofpmf.
+ *
+ * When the source is CSI_PROFILER_SOURCE_TIMER, a sample is taken by the base
+ * timer handler on every period-th tick of the periodic timer configured by
+ * csi_set_timer_tick.  This source is available on all harts, but samples can only
+ * be taken where interrupts are enabled, so time spent with interrupts disabled is
+ * attributed to the point at which they are re-enabled.
+ *
+ * The return address is only a reliable indication of the caller when the sample
+ * falls within a leaf function, or before a non-leaf function has saved ra.  Host
+ * tools should treat the ra field as a hint when building two-level stacks.
+ *
+ * Copyright (c) RISC-V International 2023. Creative Commons License. Auto-
+ * generated file: DO NOT EDIT
+ */
+
+#ifndef CSI_HL_PROFILER_H
+#define CSI_HL_PROFILER_H
+
+#include "csi_types.h"
+#include <stdint.h>
+
+/*
+ * Magic number identifying a sample ring configured by csi_profiler_init
+ */
+#define CSI_PROFILER_MAGIC (0x464F5250UL)
+
+/*
+ * Flags for the flags field of csi_profiler_config_t: CSI_PROFILER_FLAG_RA: record
+ * the return address register with each sample CSI_PROFILER_FLAG_UMODE: also take
+ * samples while the hart is in user mode
+ */
+#define CSI_PROFILER_FLAG_RA    0x1
+#define CSI_PROFILER_FLAG_UMODE 0x2
+
+
+/*
+ * Event source which drives the taking of samples.
+ */
+typedef enum {
+    CSI_PROFILER_SOURCE_TIMER = 0, /* Sample every period ticks of the periodic timer */
+    CSI_PROFILER_SOURCE_HPM, /* Sample every period events counted by a hardware performance monitor counter */
+} csi_profiler_source_t;
+
+/*
+ * Profiler configuration, passed to csi_profiler_init.  counter is the counter
+ * index (as used by the low-level hardware performance monitor API) and is ignored
+ * for the timer source.  period is the number of ticks or events between samples.
+ * flags is a combination of CSI_PROFILER_FLAG_ values.
+ */
+typedef struct {
+    csi_profiler_source_t source;
+    unsigned counter;
+    uint32_t period;
+    uint32_t flags;
+} csi_profiler_config_t;
+
+/*
+ * Header placed at the start of the sample ring by csi_profiler_init.  magic holds
+ * CSI_PROFILER_MAGIC.  hartid identifies the hart which owns the ring.  source,
+ * period and flags record the configuration.  num_samples is the number of
+ * csi_profiler_sample_t entries which follow the header.  write_idx is the free-
+ * running count of samples written, and is only written by the owning hart.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t hartid;
+    uint16_t source;
+    uint32_t period;
+    uint32_t flags;
+    uint32_t num_samples;
+    uint32_t write_idx;
+} csi_profiler_ring_hdr_t;
+
+/*
+ * A single sample.  pc holds the value of mepc at the interrupt, and ra the value
+ * of the return address register, or 0 if CSI_PROFILER_FLAG_RA was not set.  Both
+ * fields are 64 bits wide on all harts.
+ */
+typedef struct {
+    uint64_t pc;
+    uint64_t ra;
+} csi_profiler_sample_t;
+
+
+/*
+ * Configure profiling on the calling hart, writing a csi_profiler_ring_hdr_t
+ * header at the start of the supplied memory and using the remainder for samples.
+ * The location of the ring and the sampling state are held within the M-mode
+ * interrupt context space.  Profiling does not begin until csi_profiler_start is
+ * called.  Must be run in machine mode, after csi_interrupts_init.
+ *
+ * @param mctx: M-mode interrupt subsystem context pointer for the calling hart,
+ * previously initialised by csi_interrupts_init.
+ * @param ring: Memory to hold the sample ring.  Must be aligned to 8 bytes.
+ * @param ring_size: Size of memory allocated at the ring pointer in bytes.
+ * @param config: Profiler configuration.  The structure is copied and need not
+ * remain valid after the call.
+ * @return : Status of operation.  CSI_OUT_OF_MEM will be returned if ring_size
+ * does not allow at least one sample. CSI_NOT_IMPLEMENTED will be returned if the
+ * source is CSI_PROFILER_SOURCE_HPM and the hart does not implement Sscofpmf or
+ * the chosen counter.  CSI_ERROR will be returned if period is 0, or if the source
+ * is CSI_PROFILER_SOURCE_TIMER and the timer is not in periodic tick mode.
+ */
+csi_status_t csi_profiler_init(void *mctx, void *ring, unsigned ring_size, const csi_profiler_config_t *config);
+
+/*
+ * Begin (or resume) taking samples on the calling hart.  Must be run in machine
+ * mode.
+ *
+ * @param mctx: M-mode interrupt subsystem context pointer for the calling hart,
+ * previously initialised by csi_interrupts_init.
+ * @return : Status of operation.  CSI_NOT_INITIALIZED will be returned if
+ * csi_profiler_init has not been called on this hart.
+ */
+csi_status_t csi_profiler_start(void *mctx);
+
+/*
+ * Stop taking samples on the calling hart.  The ring is left intact, and sampling
+ * may be resumed by calling csi_profiler_start.  Must be run in machine mode.
+ *
+ * @param mctx: M-mode interrupt subsystem context pointer for the calling hart,
+ * previously initialised by csi_interrupts_init.
+ * @return : Number of samples taken since csi_profiler_init (the ring's
+ * write_idx).
+ */
+unsigned long csi_profiler_stop(void *mctx);
+
+
+#endif /* CSI_HL_PROFILER_H */ 
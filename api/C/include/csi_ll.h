@@ -45,8 +45,9 @@ unsigned long csi_ll_set_interrupt_enables(unsigned long int_enables);
  * other harts.  When using the RVM-CSI high-level interrupt and timer support
  * module, the timer will be compared against a compare register for each hart in
  * order to produce a regular timer interrupt at a tick rate configured using
- * csi_set_timer_tick, which is used for timing purposes.  This function must run
- * in machine mode.
+ * csi_set_timer_tick, or a one-shot interrupt at the next timeout deadline if
+ * configured using csi_set_timer_tickless, which is used for timing purposes.
+ * This function must run in machine mode.
  *
  * @param timer_freq_hz: System timer frequency in Hz
  * @return : Status of operation.  CSI_ERROR will be returned if the request is
@@ -56,14 +57,59 @@ csi_status_t csi_timer_config(unsigned long timer_freq_hz);
 
 /*
  * Read the current timer value.  This function can be called from M-mode or
- * U-mode.  However, on systems where the timer is not directly readable from
- * U-mode, the function will have to ECALL to M-mode to make the read, which will
- * likely make the value innaccurate due to the delay incurred by this.
+ * U-mode.  On RV32, where the 64-bit value is read as two halves, the high half is
+ * read before and after the low half and the sequence is repeated until the two
+ * reads of the high half agree, so a torn value is never returned. In U-mode, the
+ * value is read directly from the time and timeh CSRs if M-mode has enabled this
+ * using csi_set_umode_timer_access, which takes a few cycles and involves no trap.
+ * Otherwise, or on systems where the time CSR is not implemented in hardware, the
+ * function will have to ECALL to M-mode to make the read, which will likely make
+ * the value innaccurate due to the delay incurred by this.  Where a U-mode caller
+ * only needs tick resolution, csi_read_mtime_coarse is cheaper still in periodic
+ * tick mode.
  *
  * @return : Current timer value
  */
 uint64_t csi_read_mtime(void);
 
+/*
+ * Read a cached, coarse value of the timer, for cheap timestamps where tick
+ * resolution suffices.  When the RVM-CSI high-level interrupt and timer sub-system
+ * is running in periodic tick mode (see csi_set_timer_tick), the base trap handler
+ * stores the low XLEN bits of mtime on entry to every trap it handles, including
+ * every timer tick, in memory which is readable, but not writable, from U-mode.
+ * The cached value is returned using a single aligned load, so the call never
+ * traps and cannot return a torn value; it lags the timer by at most one tick
+ * period, plus the longest time for which the hart runs with interrupts disabled.
+ * In any other state (the sub-system not initialized on the calling hart, the
+ * timer not configured, or tickless mode, where a hart may take no trap for an
+ * unbounded time) there is no bound on the age of a cached value, so this function
+ * instead returns the low XLEN bits of csi_read_mtime, with the same cost, and in
+ * U-mode the same need for access to the time CSR.  Callers comparing values
+ * should use unsigned subtraction so that wrap-around is handled. This function
+ * can be called from M-mode or U-mode.
+ *
+ * @return : Low XLEN bits of the timer value, at most one tick period plus the
+ * longest interrupt-disabled interval old in periodic tick mode, and current
+ * otherwise.
+ */
+unsigned long csi_read_mtime_coarse(void);
+
+/*
+ * Allow or deny direct reads of the time and timeh CSRs from U-mode, by setting or
+ * clearing the TM bit of the mcounteren CSR.  When access is allowed,
+ * csi_read_mtime reads the timer in U-mode without trapping.  The same setting is
+ * controlled by bit 1 of the mask passed to csi_hpm_set_user_access.  This
+ * function must run in machine mode.
+ *
+ * @param enable: Non-zero to allow direct U-mode access; zero to deny it.
+ * @return : Status of operation.  CSI_NOT_IMPLEMENTED will be returned if the time
+ * CSR is not implemented in hardware on this system (reads of it being emulated by
+ * trapping into M-mode), in which case U-mode reads of the timer continue to use
+ * ECALL.
+ */
+csi_status_t csi_set_umode_timer_access(int enable);
+
 /*
  * Get the system timer frequency as configured by csi_timer_config.
  *
@@ -1 +1,9 @@
 /* PLACEHOLDER: replaced by content from BSP */
+
+#ifndef CSI_LL_BSP_DEFS_H
+#define CSI_LL_BSP_DEFS_H
+
+// Number of PMP entries implemented by each hart (0 to 64)
+#define CSI_PMP_NUM_ENTRIES 16
+
+#endif // CSI_LL_BSP_DEFS_H
@@ -3,6 +3,58 @@
  *
  * APIs giving access to CSRs.
  *
+ * The macros csi_csr_read to csi_csr_clear each include a "memory" clobber, so the
+ * compiler will not move memory accesses across them.  This is required when a CSR
+ * access changes how memory is accessed (for example writes to satp, or to the pmp
+ * registers), but prevents values being kept in registers around back-to-back CSR
+ * accesses.  The _relaxed variants omit the clobber; they remain ordered with
+ * respect to each other and to other CSR accesses, but not with respect to
+ * ordinary loads and stores.  The csi_csr_read2 and csi_csr_write2 families access
+ * two CSRs in a single asm statement.
+ *
+ * CSRs may be named either by their assembler names (for example mstatus) or by
+ * numeric constants (for example those in csi_ll_csrs.h).  Where numeric constants
+ * are used, CSI_CSR_ASSERT_VALID and CSI_CSR_ASSERT_WRITABLE check at compile time
+ * that the number is within the 12-bit CSR address space and, for the latter, that
+ * it is not in a read-only range (address bits 11:10 equal to 3).
+ *
+ * When CSI_CSR_HOST_MOCK is defined, every macro in this module is redirected to a
+ * host-side CSR register file, so that code built on the API (including csi_ll,
+ * csi_ll_pmp and the interrupt layer) can be compiled for and run on a host, as an
+ * ordinary executable, for unit and performance regression testing.  The register
+ * file is supplied by a host library implementing csi_csr_mock_access and the
+ * other csi_csr_mock_ functions.  Each CSR behaves as a WARL register, with the
+ * reset value and writable bits given to csi_csr_mock_define (by default, all bits
+ * are writable and the reset value is 0), and every access is recorded in a trace
+ * which tests may inspect using csi_csr_mock_get_trace.  A host BSP may attach
+ * read and write hooks to a CSR using csi_csr_mock_hook, to supply live values
+ * (for example for time, mcycle or mip) or to observe writes (for example to
+ * mstatus.MIE).  The relaxed and batched macros behave as sequences of individual
+ * accesses, and compile-time checks are retained.  In this mode the macros return
+ * unsigned long, and do not require rv_csr_t to be defined.
+ *
+ * Each use of a macro resolves its csr argument to a 12-bit CSR address once, the
+ * first time it is executed, by passing the argument as text to
+ * csi_csr_mock_resolve, and caches the address in a static variable private to
+ * that use; later executions pass the cached address straight to
+ * csi_csr_mock_access, so no string handling is done on the access path and the
+ * cost of a mock access stays small and constant.  Text which parses as a C
+ * integer constant (such as "0x300" or "768") is taken as the address; otherwise
+ * it is looked up as a CSR name, either one of the standard names from the
+ * privileged specification or a name given an address using csi_csr_mock_name.
+ * The named and numeric forms of a CSR therefore refer to the same register.
+ * Resolving a name which has no address causes the library to report the name and
+ * abort the program.
+ *
+ * The host library keeps a separate register file for each simulated hart, so that
+ * per-hart CSRs such as mhartid, mstatus, mie and the PMP registers are
+ * independent.  Each host thread has a current hart, selected using
+ * csi_csr_mock_select_hart (hart 0 for a thread which has not selected one), and
+ * all accesses made by the thread go to that hart's register file.  Reads of
+ * mhartid return the hart number.  CSR definitions made by csi_csr_mock_define,
+ * csi_csr_mock_name and csi_csr_mock_hook apply to all harts; the trace is kept
+ * per hart.
+ *
  * Copyright (c) RISC-V International 2023. Creative Commons License. Auto-
  * generated file: DO NOT EDIT
  */
@@ -22,6 +74,114 @@
 #define STRINGIFY(s)            __STR(s)
 #define __ASM                   __asm
 
+/*
+ * Compile-time checks on numeric CSR addresses.  CSI_CSR_ASSERT_VALID fails if num
+ * is not a 12-bit CSR address; CSI_CSR_ASSERT_WRITABLE also fails if num is in a
+ * read-only range.  Both may be used wherever a declaration is permitted.
+ */
+#define CSI_CSR_ASSERT_VALID(num)                               \
+    _Static_assert(((num) & ~0xFFF) == 0, "CSR address out of range")
+#define CSI_CSR_ASSERT_WRITABLE(num)                            \
+    _Static_assert(((num) & ~0xFFF) == 0 && ((num) >> 10) != 3, "CSR is read-only")
+
+/*
+ * Host mock build mode: redirect CSR accesses to the host-side register file.
+ */
+#ifdef CSI_CSR_HOST_MOCK
+#define CSI_CSR_MOCK_UNRESOLVED (~0u)
+#define __CSI_CSR_MOCK(csr, op, val)                            \
+    ({                                                          \
+        static unsigned __csi_mock_site = CSI_CSR_MOCK_UNRESOLVED; \
+        unsigned __csi_mock_addr =                              \
+            __atomic_load_n(&__csi_mock_site, __ATOMIC_RELAXED); \
+        if (__csi_mock_addr == CSI_CSR_MOCK_UNRESOLVED) {       \
+            __csi_mock_addr = csi_csr_mock_resolve(STRINGIFY(csr)); \
+            __atomic_store_n(&__csi_mock_site, __csi_mock_addr, __ATOMIC_RELAXED); \
+        }                                                       \
+        csi_csr_mock_access(__csi_mock_addr, (op), (unsigned long)(val)); \
+    })
+#define csi_csr_swap(csr, val)       __CSI_CSR_MOCK(csr, CSI_CSR_MOCK_SWAP, val)
+#define csi_csr_read(csr)            __CSI_CSR_MOCK(csr, CSI_CSR_MOCK_READ, 0)
+#define csi_csr_write(csr, val)      ((void)__CSI_CSR_MOCK(csr, CSI_CSR_MOCK_WRITE, val))
+#define csi_csr_read_set(csr, val)   __CSI_CSR_MOCK(csr, CSI_CSR_MOCK_SET, val)
+#define csi_csr_set(csr, val)        ((void)__CSI_CSR_MOCK(csr, CSI_CSR_MOCK_SET, val))
+#define csi_csr_read_clear(csr, val) __CSI_CSR_MOCK(csr, CSI_CSR_MOCK_CLEAR, val)
+#define csi_csr_clear(csr, val)      ((void)__CSI_CSR_MOCK(csr, CSI_CSR_MOCK_CLEAR, val))
+#define csi_csr_read_relaxed(csr)    csi_csr_read(csr)
+#define csi_csr_write_relaxed(csr, val) csi_csr_write(csr, val)
+#define csi_csr_read2(csr0, v0, csr1, v1)                       \
+    ({ (v0) = csi_csr_read(csr0); (v1) = csi_csr_read(csr1); })
+#define csi_csr_read2_relaxed(csr0, v0, csr1, v1) csi_csr_read2(csr0, v0, csr1, v1)
+#define csi_csr_write2(csr0, val0, csr1, val1)                  \
+    ({ csi_csr_write(csr0, val0); csi_csr_write(csr1, val1); })
+#define csi_csr_write2_relaxed(csr0, val0, csr1, val1) csi_csr_write2(csr0, val0, csr1, val1)
+#define csi_csr_set_imm(csr, imm)                               \
+    ({                                                          \
+        _Static_assert((unsigned long)(imm) <= 31,              \
+                       "csrsi immediate must be 0 to 31");      \
+        csi_csr_set(csr, imm);                                  \
+    })
+#define csi_csr_clear_imm(csr, imm)                             \
+    ({                                                          \
+        _Static_assert((unsigned long)(imm) <= 31,              \
+                       "csrci immediate must be 0 to 31");      \
+        csi_csr_clear(csr, imm);                                \
+    })
+#endif
+
+
+/*
+ * Operations performed on the host-side CSR register file in CSI_CSR_HOST_MOCK
+ * build mode.
+ */
+typedef enum {
+    CSI_CSR_MOCK_READ = 0, /* Read the CSR */
+    CSI_CSR_MOCK_WRITE, /* Write the operand to the CSR */
+    CSI_CSR_MOCK_SWAP, /* Read the CSR, then write the operand to it */
+    CSI_CSR_MOCK_SET, /* Read the CSR, then set the bits given by the operand */
+    CSI_CSR_MOCK_CLEAR, /* Read the CSR, then clear the bits given by the operand */
+} csi_csr_mock_op_t;
+
+/*
+ * Function prototype for a read hook attached to a CSR using csi_csr_mock_hook.
+ * The hook is called on the accessing thread at the start of every access to the
+ * CSR, and returns the value the CSR holds at that moment; this is the value
+ * returned by the access, and the base for any write, set or clear.
+ *
+ * @param hartid: Hart whose register file is being accessed.
+ * @param address: Address of the CSR.
+ * @param stored_value: Value held for the CSR in the hart's register file.
+ * @param hook_ctx: Context pointer that was passed into csi_csr_mock_hook.
+ */
+typedef unsigned long (csi_csr_mock_read_hook_t)(unsigned hartid, unsigned address, unsigned long stored_value, void *hook_ctx);
+
+/*
+ * Function prototype for a write hook attached to a CSR using csi_csr_mock_hook.
+ * The hook is called on the accessing thread after every access to the CSR other
+ * than a read, once the new value (after applying the writable mask) has been
+ * stored.
+ *
+ * @param hartid: Hart whose register file is being accessed.
+ * @param address: Address of the CSR.
+ * @param old_value: Value of the CSR before the access.
+ * @param new_value: Value of the CSR after the access.
+ * @param hook_ctx: Context pointer that was passed into csi_csr_mock_hook.
+ */
+typedef void (csi_csr_mock_write_hook_t)(unsigned hartid, unsigned address, unsigned long old_value, unsigned long new_value, void *hook_ctx);
+
+/*
+ * One entry in the access trace of the host-side CSR register file.  address is
+ * the address of the CSR, op and operand describe the access, and old_value and
+ * new_value give the content of the CSR before and after it.
+ */
+typedef struct {
+    unsigned address;
+    csi_csr_mock_op_t op;
+    unsigned long operand;
+    unsigned long old_value;
+    unsigned long new_value;
+} csi_csr_mock_trace_t;
+
 
 /*
  * Read the content of csr register to __v, then write content of val into csr
@@ -31,6 +191,7 @@
  * @param val: value to store into the CSR register
  * @return : the CSR register value before written
  */
+#ifndef CSI_CSR_HOST_MOCK
 #define csi_csr_swap(csr, val)                                  \
     ({                                                          \
         rv_csr_t __v = (unsigned long)(val);                    \
@@ -40,6 +201,7 @@
                     : "memory");                               \
         __v;                                                    \
     })
+#endif
 
 /*
  * Read the content of csr register to __v and return it.
@@ -47,6 +209,7 @@
  * @param csr: CSR macro definition
  * @return : the CSR register value
  */
+#ifndef CSI_CSR_HOST_MOCK
 #define csi_csr_read(csr)                                       \
     ({                                                          \
         rv_csr_t __v;                                           \
@@ -56,6 +219,7 @@
                       : "memory");                               \
         __v;                                                    \
     })
+#endif
 
 /*
  * Write the content of val to csr register.
@@ -63,6 +227,7 @@
  * @param csr: CSR macro definition
  * @param val: value to store into the CSR register
  */
+#ifndef CSI_CSR_HOST_MOCK
 #define csi_csr_write(csr, val)                                 \
     ({                                                          \
         rv_csr_t __v = (rv_csr_t)(val);                         \
@@ -71,6 +236,7 @@
                       : "rK"(__v)                                \
                       : "memory");                               \
     })
+#endif
 
 /*
  * Read the content of csr register to __v, then set csr register to be __v | val,
@@ -80,6 +246,7 @@
  * @param val: Mask value to be used wih csrrs instruction
  * @return : the CSR register value before written
  */
+#ifndef CSI_CSR_HOST_MOCK
 #define csi_csr_read_set(csr, val)                              \
     ({                                                          \
         rv_csr_t __v = (rv_csr_t)(val);                         \
@@ -89,6 +256,7 @@
                     : "memory");                               \
         __v;                                                    \
     })
+#endif
 
 /*
  * Set csr register to be csr_content | val.
@@ -96,6 +264,7 @@
  * @param csr: CSR macro definition
  * @param val: Mask value to be used wih csrs instruction
  */
+#ifndef CSI_CSR_HOST_MOCK
 #define csi_csr_set(csr, val)                                   \
     ({                                                          \
         rv_csr_t __v = (rv_csr_t)(val);                         \
@@ -104,6 +273,7 @@
                     : "rK"(__v)                                \
                     : "memory");                               \
     })
+#endif
 
 /*
  * Read the content of csr register to __v, then set csr register to be __v & ~val,
@@ -113,6 +283,7 @@
  * @param val: Mask value to be used wih csrrc instruction
  * @return : the CSR register value before written
  */
+#ifndef CSI_CSR_HOST_MOCK
 #define csi_csr_read_clear(csr, val)                            \
     ({                                                          \
         rv_csr_t __v = (rv_csr_t)(val);                         \
@@ -122,6 +293,7 @@
                     : "memory");                               \
         __v;                                                    \
     })
+#endif
 
 /*
  * Set csr register to be csr_content & ~val
@@ -129,6 +301,7 @@
  * @param csr: CSR macro definition
  * @param val: Mask value to be used wih csrc instruction
  */
+#ifndef CSI_CSR_HOST_MOCK
 #define csi_csr_clear(csr, val)                                 \
     ({                                                          \
         rv_csr_t __v = (rv_csr_t)(val);                         \
@@ -137,6 +310,271 @@
                     : "rK"(__v)                                \
                     : "memory");                               \
     })
+#endif
+
+/*
+ * As csi_csr_read, but without a memory clobber, so the compiler may move memory
+ * accesses across the read.
+ *
+ * @param csr: CSR macro definition
+ * @return : the CSR register value
+ */
+#ifndef CSI_CSR_HOST_MOCK
+#define csi_csr_read_relaxed(csr)                               \
+    ({                                                          \
+        rv_csr_t __v;                                           \
+        __ASM volatile("csrr %0, " STRINGIFY(csr)               \
+                      : "=r"(__v));                              \
+        __v;                                                    \
+    })
+#endif
+
+/*
+ * As csi_csr_write, but without a memory clobber, so the compiler may move memory
+ * accesses across the write.
+ *
+ * @param csr: CSR macro definition
+ * @param val: value to store into the CSR register
+ */
+#ifndef CSI_CSR_HOST_MOCK
+#define csi_csr_write_relaxed(csr, val)                         \
+    ({                                                          \
+        rv_csr_t __v = (rv_csr_t)(val);                         \
+        __ASM volatile("csrw " STRINGIFY(csr) ", %0"            \
+                      :                                          \
+                      : "rK"(__v));                              \
+    })
+#endif
+
+/*
+ * Read the content of two csr registers, in order, in a single asm statement,
+ * storing them into v0 and v1.
+ *
+ * @param csr0: CSR macro definition of the first register
+ * @param v0: lvalue to receive the value of csr0
+ * @param csr1: CSR macro definition of the second register
+ * @param v1: lvalue to receive the value of csr1
+ */
+#ifndef CSI_CSR_HOST_MOCK
+#define csi_csr_read2(csr0, v0, csr1, v1)                       \
+    ({                                                          \
+        rv_csr_t __v0, __v1;                                    \
+        __ASM volatile("csrr %0, " STRINGIFY(csr0) "\n\t"       \
+                       "csrr %1, " STRINGIFY(csr1)              \
+                      : "=r"(__v0), "=r"(__v1)                   \
+                      :                                          \
+                      : "memory");                               \
+        (v0) = __v0;                                            \
+        (v1) = __v1;                                            \
+    })
+#endif
+
+/*
+ * As csi_csr_read2, but without a memory clobber.
+ *
+ * @param csr0: CSR macro definition of the first register
+ * @param v0: lvalue to receive the value of csr0
+ * @param csr1: CSR macro definition of the second register
+ * @param v1: lvalue to receive the value of csr1
+ */
+#ifndef CSI_CSR_HOST_MOCK
+#define csi_csr_read2_relaxed(csr0, v0, csr1, v1)               \
+    ({                                                          \
+        rv_csr_t __v0, __v1;                                    \
+        __ASM volatile("csrr %0, " STRINGIFY(csr0) "\n\t"       \
+                       "csrr %1, " STRINGIFY(csr1)              \
+                      : "=r"(__v0), "=r"(__v1));                 \
+        (v0) = __v0;                                            \
+        (v1) = __v1;                                            \
+    })
+#endif
+
+/*
+ * Write val0 to csr0 and then val1 to csr1, in a single asm statement.
+ *
+ * @param csr0: CSR macro definition of the first register
+ * @param val0: value to store into csr0
+ * @param csr1: CSR macro definition of the second register
+ * @param val1: value to store into csr1
+ */
+#ifndef CSI_CSR_HOST_MOCK
+#define csi_csr_write2(csr0, val0, csr1, val1)                  \
+    ({                                                          \
+        rv_csr_t __v0 = (rv_csr_t)(val0);                       \
+        rv_csr_t __v1 = (rv_csr_t)(val1);                       \
+        __ASM volatile("csrw " STRINGIFY(csr0) ", %0\n\t"       \
+                       "csrw " STRINGIFY(csr1) ", %1"           \
+                      :                                          \
+                      : "rK"(__v0), "rK"(__v1)                   \
+                      : "memory");                               \
+    })
+#endif
+
+/*
+ * As csi_csr_write2, but without a memory clobber.
+ *
+ * @param csr0: CSR macro definition of the first register
+ * @param val0: value to store into csr0
+ * @param csr1: CSR macro definition of the second register
+ * @param val1: value to store into csr1
+ */
+#ifndef CSI_CSR_HOST_MOCK
+#define csi_csr_write2_relaxed(csr0, val0, csr1, val1)          \
+    ({                                                          \
+        rv_csr_t __v0 = (rv_csr_t)(val0);                       \
+        rv_csr_t __v1 = (rv_csr_t)(val1);                       \
+        __ASM volatile("csrw " STRINGIFY(csr0) ", %0\n\t"       \
+                       "csrw " STRINGIFY(csr1) ", %1"           \
+                      :                                          \
+                      : "rK"(__v0), "rK"(__v1));                 \
+    })
+#endif
+
+/*
+ * Set bits in csr register using the immediate form csrsi.  imm must be a constant
+ * from 0 to 31; this is checked at compile time.
+ *
+ * @param csr: CSR macro definition
+ * @param imm: Constant mask of bits to set, from 0 to 31
+ */
+#ifndef CSI_CSR_HOST_MOCK
+#define csi_csr_set_imm(csr, imm)                               \
+    ({                                                          \
+        _Static_assert((unsigned long)(imm) <= 31,              \
+                       "csrsi immediate must be 0 to 31");      \
+        __ASM volatile("csrsi " STRINGIFY(csr) ", %0"           \
+                    :                                          \
+                    : "i"(imm)                                 \
+                    : "memory");                               \
+    })
+#endif
+
+/*
+ * Clear bits in csr register using the immediate form csrci.  imm must be a
+ * constant from 0 to 31; this is checked at compile time.
+ *
+ * @param csr: CSR macro definition
+ * @param imm: Constant mask of bits to clear, from 0 to 31
+ */
+#ifndef CSI_CSR_HOST_MOCK
+#define csi_csr_clear_imm(csr, imm)                             \
+    ({                                                          \
+        _Static_assert((unsigned long)(imm) <= 31,              \
+                       "csrci immediate must be 0 to 31");      \
+        __ASM volatile("csrci " STRINGIFY(csr) ", %0"           \
+                    :                                          \
+                    : "i"(imm)                                 \
+                    : "memory");                               \
+    })
+#endif
+
+
+/*
+ * Map the text of a csr argument to a CSR address, as described above.  This is
+ * called by the CSR access macros in CSI_CSR_HOST_MOCK build mode the first time
+ * each use of a macro is executed, and is not normally called directly.
+ *
+ * @param csr: Name or number of the CSR, as text.
+ * @return : 12-bit CSR address.  The program is aborted if csr names no known CSR.
+ */
+unsigned csi_csr_mock_resolve(const char *csr);
+
+/*
+ * Perform an access on the host-side CSR register file of the calling thread's
+ * current hart.  This is called by the CSR access macros in CSI_CSR_HOST_MOCK
+ * build mode, and is not normally called directly.  If the CSR has a read hook, it
+ * supplies the value before the access.  Bits which are not writable, as defined
+ * by csi_csr_mock_define, keep their previous value.  If the access is not a read
+ * and the CSR has a write hook, it is called once the new value has been stored.
+ * The access is appended to the trace.
+ *
+ * @param address: 12-bit CSR address, as returned by csi_csr_mock_resolve.
+ * @param op: Operation to perform.
+ * @param operand: Value to write, or mask of bits to set or clear; ignored for
+ * CSI_CSR_MOCK_READ.
+ * @return : Content of the CSR before the access.
+ */
+unsigned long csi_csr_mock_access(unsigned address, csi_csr_mock_op_t op, unsigned long operand);
+
+/*
+ * Define the reset value and writable bits of a CSR, and set the CSR to its reset
+ * value in the register file of every hart.  A mask of 0 models a read-only CSR.
+ * The definition applies to all harts, except that mhartid always reads as the
+ * hart number.
+ *
+ * @param csr: Name or number of the CSR, as text, mapped to a CSR address as
+ * described above.
+ * @param reset_value: Value of the CSR after definition and after
+ * csi_csr_mock_reset.
+ * @param writable_mask: Mask of bits which accesses may change.
+ * @return : Status of operation.  CSI_OUT_OF_MEM will be returned if the register
+ * file is full.
+ */
+csi_status_t csi_csr_mock_define(const char *csr, unsigned long reset_value, unsigned long writable_mask);
+
+/*
+ * Give an address to a CSR name, typically that of an implementation-specific CSR
+ * listed in csi_ll_bsp_csrs.h, so that the named and numeric forms refer to the
+ * same register.  A standard CSR name may not be redefined.
+ *
+ * @param name: Name of the CSR, as used in the csr argument of the CSR access
+ * macros.
+ * @param address: 12-bit CSR address.
+ * @return : Status of operation.  CSI_ERROR will be returned if address is not a
+ * 12-bit CSR address, or if name is a standard CSR name or already has a different
+ * address.  CSI_OUT_OF_MEM will be returned if the name table is full.
+ */
+csi_status_t csi_csr_mock_name(const char *name, unsigned address);
+
+/*
+ * Attach read and write hooks to a CSR, replacing any previously attached.  Hooks
+ * apply to the CSR in the register file of every hart, and are called with the
+ * hart number, so a host BSP can back per-hart CSRs with its own state.  Hooks may
+ * themselves access other CSRs, but must not access the CSR to which they are
+ * attached.
+ *
+ * @param csr: Name or number of the CSR, as text, mapped to a CSR address as
+ * described above.
+ * @param read_fn: Read hook, or NULL for none.
+ * @param write_fn: Write hook, or NULL for none.
+ * @param hook_ctx: Context pointer passed to both hooks.
+ * @return : Status of operation.  CSI_OUT_OF_MEM will be returned if the hook
+ * table is full.
+ */
+csi_status_t csi_csr_mock_hook(const char *csr, csi_csr_mock_read_hook_t *read_fn, csi_csr_mock_write_hook_t *write_fn, void *hook_ctx);
+
+/*
+ * Select the simulated hart whose register file is used by accesses made from the
+ * calling host thread.  A hart's register file is created, with every CSR at its
+ * reset value, the first time the hart is selected.  A host BSP simulating several
+ * harts calls this function on each hart's thread before running code on it.
+ *
+ * @param hartid: Hart number, which is also the value read from mhartid.
+ * @return : Status of operation.  CSI_OUT_OF_MEM will be returned if a register
+ * file cannot be created for the hart.
+ */
+csi_status_t csi_csr_mock_select_hart(unsigned hartid);
+
+/*
+ * Return every CSR in the calling thread's current hart's register file to its
+ * reset value, and empty that hart's trace.  CSR definitions made using
+ * csi_csr_mock_define and csi_csr_mock_name are kept.
+ *
+ * @return : None
+ */
+void csi_csr_mock_reset(void);
+
+/*
+ * Copy the most recent entries of the access trace of the calling thread's current
+ * hart, oldest first.
+ *
+ * @param entries: Array to receive trace entries.
+ * @param max_entries: Number of elements in the entries array.
+ * @return : Total number of accesses recorded since the last call to
+ * csi_csr_mock_reset, which may exceed the number of entries copied.
+ */
+unsigned long csi_csr_mock_get_trace(csi_csr_mock_trace_t *entries, unsigned max_entries);
+
 
 #endif // __ASSEMBLER__
 
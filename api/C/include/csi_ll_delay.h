@@ -0,0 +1,158 @@
+/*
+ * Low-Level Delay API
+ *
+ * This module provides calibrated delays and timeouts for use when polling
+ * hardware.  The hart's cycle rate is measured against the system timer by
+ * csi_delay_init, so that short delays can be timed in cycles and longer ones
+ * against mtime.  csi_delay_us and csi_delay_wfi_us match the
+ * csi_poll_wait_wrapper_t prototype, and may be passed directly as the wait_fn
+ * argument of csi_uart_init and other functions which poll.
+ *
+ * Delays are measured by reading the cycle counter, not by counting loop
+ * iterations, so their accuracy does not depend on the compiler or pipeline.  A
+ * delay never ends early; it may end late by the time taken to return from the
+ * function, or by the time spent in any interrupt handler which runs during it.
+ *
+ * In U-mode, cycle-timed delays require read access to the cycle CSR, granted by
+ * M-mode using csi_hpm_set_user_access.  Without it, csi_delay_us and
+ * csi_delay_cycles time all delays against mtime using csi_read_mtime.
+ *
+ * The deadline helpers express deadlines as mtime values, so a deadline remains
+ * valid if the hart's clock rate changes, and may be passed between harts.
+ *
+ * Copyright (c) RISC-V International 2023. Creative Commons License. Auto-
+ * generated file: DO NOT EDIT
+ */
+
+#ifndef CSI_LL_DELAY_H
+#define CSI_LL_DELAY_H
+
+#include "csi_types.h"
+#include <stdint.h>
+
+/*
+ * Poll until an expression becomes true or a timeout expires.  cond is evaluated
+ * repeatedly, with wait_fn(wait_time_us) called between evaluations if wait_fn is
+ * not NULL; cond is always evaluated once more after the timeout expires, so a
+ * condition which became true while waiting is not reported as a timeout.
+ *
+ * @param cond: Expression to poll
+ * @param timeout_us: Maximum time to wait in microseconds
+ * @param wait_fn: Function to call between polls, such as csi_delay_us, or NULL to
+ * spin
+ * @param wait_time_us: Wait time passed to wait_fn
+ * @return : CSI_SUCCESS if cond became true, or CSI_TIMEOUT
+ */
+#define csi_delay_poll(cond, timeout_us, wait_fn, wait_time_us)         \
+    ({                                                                  \
+        uint64_t __deadline = csi_delay_deadline(timeout_us);           \
+        csi_poll_wait_wrapper_t *__wait = (wait_fn);                    \
+        csi_status_t __status = CSI_SUCCESS;                            \
+        while (!(cond)) {                                               \
+            if (csi_delay_expired(__deadline)) {                        \
+                __status = (cond) ? CSI_SUCCESS : CSI_TIMEOUT;          \
+                break;                                                  \
+            }                                                           \
+            if (__wait)                                                 \
+                __wait(wait_time_us);                                   \
+        }                                                               \
+        __status;                                                       \
+    })
+
+
+/*
+ * Calibrate the delay functions for the calling hart, by counting the cycles which
+ * elapse over an interval of the system timer.  The calibration takes
+ * approximately 1 ms.  This function must be called once on each hart which uses
+ * cycle-timed delays, after csi_timer_config and with interrupts disabled, and
+ * again if the hart's clock rate is changed.  Must be run in machine mode.
+ *
+ * @return : Status of operation.  CSI_NOT_INITIALIZED will be returned if the
+ * timer frequency has not been configured. CSI_NOT_IMPLEMENTED will be returned if
+ * the hart does not implement mcycle, in which case all delays are timed against
+ * mtime.
+ */
+csi_status_t csi_delay_init(void);
+
+/*
+ * Get the number of hart cycles per microsecond measured by csi_delay_init.
+ *
+ * @return : Cycles per microsecond, or 0 if csi_delay_init has not been run
+ * successfully on the calling hart.
+ */
+unsigned long csi_delay_get_cycles_per_us(void);
+
+/*
+ * Busy-wait for at least the given number of hart cycles.  Where the cycle counter
+ * can be read, the delay is timed against it directly, does not require
+ * calibration, and is exact apart from the overheads described in the notes above.
+ * Otherwise (in U-mode without access to the cycle CSR, or on a hart without
+ * mcycle) the delay is timed against mtime: the number of cycles is converted to
+ * mtime increments using the calibration from csi_delay_init and rounded up, so
+ * the delay may be longer than requested by up to one mtime increment.  If
+ * csi_delay_init has not been run successfully on the calling hart, the conversion
+ * assumes one cycle per mtime increment, which never ends early on a hart clocked
+ * at or above the timer frequency, but may be many times longer than requested.
+ * It can be called from M-mode or U-mode.
+ *
+ * @param cycles: Number of cycles to wait.
+ * @return : None
+ */
+void csi_delay_cycles(unsigned long cycles);
+
+/*
+ * Busy-wait for at least the given number of microseconds.  Delays shorter than
+ * one increment of mtime (the period of the frequency set by csi_timer_config,
+ * independent of any tick configured by csi_set_timer_tick) are timed in cycles
+ * using the calibration from csi_delay_init; longer delays are timed against
+ * mtime, rounded up to a whole number of increments.  It can be called from M-mode
+ * or U-mode.  This function matches the csi_poll_wait_wrapper_t prototype.
+ *
+ * @param wait_time_us: Wait time in microseconds.
+ * @return : None
+ */
+void csi_delay_us(unsigned wait_time_us);
+
+/*
+ * Wait for at least the given number of microseconds in a low-power state.  The
+ * hart sets a deadline using csi_set_m_deadline and executes WFI until the
+ * deadline has passed; other interrupts are serviced as usual while waiting.
+ * Since this function takes no context arguments, the BSP obtains the calling
+ * hart's M-mode context pointer from its own per-hart record of the pointer passed
+ * to csi_interrupts_init, and uses a csi_timeout_t reserved for this function
+ * within that context space (included in CSI_INTERRUPT_MCTX_MIN_SIZE_BYTES).  This
+ * function behaves as csi_delay_us, busy-waiting instead, if any of the following
+ * apply: the RVM-CSI high-level interrupt and timer sub-system has not been
+ * initialized on the calling hart; the timer has not been configured using
+ * csi_set_timer_tick or csi_set_timer_tickless; the delay is shorter than one
+ * increment of mtime, as for csi_delay_us; or the reserved timeout is already in
+ * use, because this function has been called from a handler which interrupted a
+ * low-power wait on the same hart.  Must be run in machine mode.  This function
+ * matches the csi_poll_wait_wrapper_t prototype.
+ *
+ * @param wait_time_us: Wait time in microseconds.
+ * @return : None
+ */
+void csi_delay_wfi_us(unsigned wait_time_us);
+
+/*
+ * Compute a deadline the given number of microseconds from now, for use with
+ * csi_delay_expired.  It can be called from M-mode or U-mode.
+ *
+ * @param timeout_us: Time until the deadline in microseconds.
+ * @return : Deadline as an mtime value.
+ */
+uint64_t csi_delay_deadline(unsigned timeout_us);
+
+/*
+ * Check whether a deadline computed by csi_delay_deadline has passed.  It can be
+ * called from M-mode or U-mode.
+ *
+ * @param deadline: Deadline as an mtime value.
+ * @return : Non-zero if the current value of mtime is at or after the deadline;
+ * zero otherwise.
+ */
+int csi_delay_expired(uint64_t deadline);
+
+
+#endif /* CSI_LL_DELAY_H */ 
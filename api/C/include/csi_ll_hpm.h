@@ -0,0 +1,212 @@
+/*
+ * Low-Level Hardware Performance Monitor API
+ *
+ * This module provides access to the per-hart hardware performance monitor: the
+ * mcycle and minstret counters and the programmable mhpmcounter3 to mhpmcounter31
+ * counters with their mhpmevent selectors.  Counters are identified by their index
+ * into the mcountinhibit and mcounteren registers: 0 is mcycle, 2 is minstret and
+ * 3 to 31 are the programmable counters (index 1 is the time register, which is
+ * not a hart counter and is not supported here). Counter values are always
+ * returned as 64 bits, including on RV32.
+ *
+ * On RV32 each counter is read as two CSRs.  Reads use the sequence high / low /
+ * high, repeating until both reads of the high half agree, so that a carry from
+ * the low half between the two accesses can never produce a torn value.  The macro
+ * csi_hpm_read_csr64 gives the same sequence for a counter named at compile time,
+ * for use in code where a function call is not acceptable.
+ *
+ * The event codes written to mhpmevent registers are implementation-specific; they
+ * are listed by the BSP in csi_ll_bsp_csrs.h.
+ *
+ * The region API (csi_hpm_region_init, csi_hpm_region_start, csi_hpm_region_stop
+ * and csi_hpm_region_snapshot) is intended for profiling sections of code, such as
+ * hot loops, in production firmware.  A region accumulates the counts for up to
+ * CSI_HPM_REGION_MAX_COUNTERS counters over any number of start / stop pairs; the
+ * counters themselves keep running and may be shared by any number of regions.
+ *
+ * Copyright (c) RISC-V International 2023. Creative Commons License. Auto-
+ * generated file: DO NOT EDIT
+ */
+
+#ifndef CSI_LL_HPM_H
+#define CSI_LL_HPM_H
+
+#include "csi_types.h"
+#include "csi_ll_csr_access.h"
+#include <stdint.h>
+
+/*
+ * Counter indices of the fixed counters, and the first and last programmable
+ * counters.
+ */
+#define CSI_HPM_CYCLE          0
+#define CSI_HPM_INSTRET        2
+#define CSI_HPM_FIRST_EVENT    3
+#define CSI_HPM_LAST_EVENT     31
+
+/*
+ * Maximum number of counters which can be tracked by a single profiling region.
+ */
+#define CSI_HPM_REGION_MAX_COUNTERS 4
+
+
+/*
+ * State of a profiling region.  The caller allocates this structure, and
+ * initializes it using csi_hpm_region_init.  Its fields may be read directly, but
+ * should only be modified through this API.
+ */
+typedef struct {
+    unsigned num_counters;
+    unsigned char counters[CSI_HPM_REGION_MAX_COUNTERS];
+    uint64_t start[CSI_HPM_REGION_MAX_COUNTERS];
+    uint64_t total[CSI_HPM_REGION_MAX_COUNTERS];
+    unsigned long entries;
+} csi_hpm_region_t;
+
+
+/*
+ * Read a 64-bit counter CSR named at compile time, for example
+ * csi_hpm_read_csr64(mcycle, mcycleh).  On RV32 the high half is read before and
+ * after the low half, and the sequence is repeated if the two reads differ.  On
+ * RV64 a single read of csr is made and csrh is ignored.
+ *
+ * @param csr: CSR holding the counter, or its low half on RV32
+ * @param csrh: CSR holding the high half of the counter on RV32
+ * @return : the 64-bit counter value
+ */
+#if __riscv_xlen == 32
+#define csi_hpm_read_csr64(csr, csrh)                           \
+    ({                                                          \
+        uint32_t __hi, __lo, __hi2;                             \
+        do {                                                    \
+            __hi = csi_csr_read(csrh);                          \
+            __lo = csi_csr_read(csr);                           \
+            __hi2 = csi_csr_read(csrh);                         \
+        } while (__hi != __hi2);                                \
+        ((uint64_t)__hi << 32) | __lo;                          \
+    })
+#else
+#define csi_hpm_read_csr64(csr, csrh)                           \
+    ((uint64_t)csi_csr_read(csr))
+#endif
+
+
+/*
+ * Get the number of programmable counters implemented by the calling hart, from
+ * mhpmcounter3 upwards.  Must be run in machine mode.
+ *
+ * @return : Number of programmable counters implemented, from 0 to 29.
+ */
+unsigned csi_hpm_get_num_counters(void);
+
+/*
+ * Select the event counted by a programmable counter, by writing its mhpmevent
+ * register.  The counter value is not changed; use csi_hpm_write to reset it.
+ * Must be run in machine mode.
+ *
+ * @param idx: Counter index, from CSI_HPM_FIRST_EVENT to CSI_HPM_LAST_EVENT.
+ * @param event: Implementation-specific event code, as listed in
+ * csi_ll_bsp_csrs.h.  0 stops the counter from counting any event.
+ * @return : Status of operation.  CSI_ERROR will be returned if idx is not a
+ * programmable counter implemented by the calling hart.
+ */
+csi_status_t csi_hpm_set_event(unsigned idx, unsigned long event);
+
+/*
+ * Stop or start counters, by writing the mcountinhibit register.  A counter whose
+ * bit is set in the mask does not increment.  Inhibiting unused counters saves
+ * power.  Must be run in machine mode.
+ *
+ * @param mask: Bit mask of counter indices to inhibit.  Bit 1 is ignored.
+ * @return : Previous value of mcountinhibit, allowing the caller to restore it.
+ */
+uint32_t csi_hpm_set_inhibit(uint32_t mask);
+
+/*
+ * Allow or deny read access to counters from lower privilege modes, by writing the
+ * mcounteren register.  A counter whose bit is set in the mask may be read
+ * directly using the unprivileged cycle, instret and hpmcounter CSRs. Must be run
+ * in machine mode.
+ *
+ * @param mask: Bit mask of counter indices to make accessible.  Bit 1 controls
+ * access to the time CSR.
+ * @return : Previous value of mcounteren, allowing the caller to restore it.
+ */
+uint32_t csi_hpm_set_user_access(uint32_t mask);
+
+/*
+ * Read the current 64-bit value of a counter.  On RV32 the high / low / high
+ * sequence described above is used. Must be run in machine mode.
+ *
+ * @param idx: Counter index: CSI_HPM_CYCLE, CSI_HPM_INSTRET, or a programmable
+ * counter index.
+ * @return : Counter value.  0 is returned if idx is not a counter implemented by
+ * the calling hart.
+ */
+uint64_t csi_hpm_read(unsigned idx);
+
+/*
+ * Write a 64-bit value to a counter, usually to reset it to 0.  On RV32 the low
+ * half is first written to zero so that no carry can reach the high half between
+ * the two writes.  Must be run in machine mode.
+ *
+ * @param idx: Counter index: CSI_HPM_CYCLE, CSI_HPM_INSTRET, or a programmable
+ * counter index.
+ * @param value: New counter value.
+ * @return : Status of operation.  CSI_ERROR will be returned if idx is not a
+ * counter implemented by the calling hart.
+ */
+csi_status_t csi_hpm_write(unsigned idx, uint64_t value);
+
+/*
+ * Initialize a profiling region, choosing the counters it tracks and zeroing its
+ * totals.  The counters should already be configured using csi_hpm_set_event and
+ * not inhibited.  Must be run in machine mode.
+ *
+ * @param region: Region to initialize.
+ * @param counters: Array of counter indices to track.
+ * @param num_counters: Number of entries in the counters array, up to
+ * CSI_HPM_REGION_MAX_COUNTERS.
+ * @return : Status of operation.  CSI_ERROR will be returned if num_counters
+ * exceeds CSI_HPM_REGION_MAX_COUNTERS or any index is not a counter implemented by
+ * the calling hart.
+ */
+csi_status_t csi_hpm_region_init(csi_hpm_region_t *region, const unsigned char *counters, unsigned num_counters);
+
+/*
+ * Mark the start of the profiled code, recording the current value of each tracked
+ * counter.  This function is kept short so that it adds few cycles and
+ * instructions to the counts.  Must be run in machine mode.
+ *
+ * @param region: Region previously initialized by csi_hpm_region_init.
+ * @return : None
+ */
+void csi_hpm_region_start(csi_hpm_region_t *region);
+
+/*
+ * Mark the end of the profiled code, adding the counts since the matching
+ * csi_hpm_region_start to the region's totals and incrementing its entries count.
+ * Must be run in machine mode.
+ *
+ * @param region: Region previously started by csi_hpm_region_start.
+ * @return : None
+ */
+void csi_hpm_region_stop(csi_hpm_region_t *region);
+
+/*
+ * Copy the accumulated totals of a region, and optionally reset them.  This may be
+ * called while the region is not running, for example periodically to report the
+ * profile of a hot loop.
+ *
+ * @param region: Region to read.
+ * @param totals: Array into which the total for each tracked counter is copied, in
+ * the order passed to csi_hpm_region_init. Must have space for the region's
+ * num_counters entries.
+ * @param reset: If non-zero, the region's totals and entries count are reset to
+ * zero after being copied.
+ * @return : Number of start / stop pairs included in the totals.
+ */
+unsigned long csi_hpm_region_snapshot(csi_hpm_region_t *region, uint64_t *totals, int reset);
+
+
+#endif /* CSI_LL_HPM_H */ 
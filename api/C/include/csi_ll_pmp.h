@@ -11,6 +11,8 @@
 #define CSI_LL_PMP_H
 
 #include "csi_types.h"
+#include "csi_ll_bsp_defs.h"
+#include <stdint.h>
 
 /*
  * Attribute definitions of PMP entry: PMP_ATTR_FLAG_R: indicate that the PMP entry
@@ -36,6 +38,76 @@
 #define PMP_ATTR_ADDR_MATCHING_NA4		  0x10
 #define PMP_ATTR_ADDR_MATCHING_NAPOT	  0x18
 
+/*
+ * XLEN of the target whose PMP registers are described by csi_pmp_entry_t and
+ * csi_pmp_profile_t, and the matching register type.  When building for RISC-V
+ * this is taken from the compiler.  On a host it defaults to the width of unsigned
+ * long, which suits host and mock builds; when precomputing layouts or profiles
+ * for a target, CSI_PMP_XLEN should be defined as 32 or 64 to match the target.
+ */
+#ifndef CSI_PMP_XLEN
+#if defined(__riscv_xlen)
+#define CSI_PMP_XLEN __riscv_xlen
+#elif defined(__SIZEOF_LONG__)
+#define CSI_PMP_XLEN (__SIZEOF_LONG__ * 8)
+#else
+#error "CSI_PMP_XLEN must be defined as 32 or 64"
+#endif
+#endif
+#if (CSI_PMP_XLEN == 32)
+typedef uint32_t csi_pmp_reg_t;
+#else
+typedef uint64_t csi_pmp_reg_t;
+#endif
+
+/*
+ * Number of entries held in a csi_pmp_profile_t: CSI_PMP_NUM_ENTRIES, or 1 on
+ * harts without PMP, so that the profile arrays are never of zero length
+ */
+#define CSI_PMP_PROFILE_ENTRIES (CSI_PMP_NUM_ENTRIES > 0 ? CSI_PMP_NUM_ENTRIES : 1)
+
+
+/*
+ * A memory region to be described by csi_pmp_plan_layout or csi_pmp_apply_layout.
+ * pmp_attr holds a combination of the PMP_ATTR_FLAG_ values; the address-matching
+ * mode is chosen by the planner.  Addresses are 64 bits wide on all targets, so
+ * that the same region list can be used on a host and on RV32 targets with
+ * physical addresses above 4 GiB.
+ */
+typedef struct {
+    uint64_t base_addr;
+    uint64_t size;
+    uint8_t pmp_attr;
+} csi_pmp_region_t;
+
+/*
+ * A PMP entry as computed by csi_pmp_plan_layout, holding the values to be written
+ * to its pmpaddr register and its byte of the pmpcfg registers.  The layout
+ * depends only on CSI_PMP_XLEN, not on the compiling machine: the reserved bytes
+ * pad the structure explicitly to twice the size of csi_pmp_reg_t.
+ */
+typedef struct {
+    csi_pmp_reg_t pmpaddr;
+    uint8_t pmpcfg;
+    uint8_t reserved[sizeof(csi_pmp_reg_t) - 1];
+} csi_pmp_entry_t;
+
+/*
+ * A complete image of the PMP registers of a hart, used to switch quickly between
+ * memory protection configurations, for example on each task switch in an RTOS.
+ * pmpaddr holds the value of each pmpaddr register, and pmpcfg the configuration
+ * byte of each entry, both in entry order.  csi_pmp_switch assembles the pmpcfg
+ * register values from consecutive bytes (4 per register on RV32, 8 on RV64, where
+ * only the even-numbered pmpcfg registers exist).  The layout depends only on
+ * CSI_PMP_XLEN and CSI_PMP_NUM_ENTRIES, not on the compiling machine, so profiles
+ * may be built on a host and placed in the target's read-only memory.  Profiles
+ * are built using csi_pmp_profile_build or csi_pmp_profile_capture.
+ */
+typedef struct {
+    csi_pmp_reg_t pmpaddr[CSI_PMP_PROFILE_ENTRIES];
+    uint8_t pmpcfg[CSI_PMP_PROFILE_ENTRIES];
+} csi_pmp_profile_t;
+
 
 /*
  * Get the number of PMP entries for the hard id. If the hart id is invalid, such
@@ -89,5 +161,136 @@ csi_status_t csi_pmp_set_entry(unsigned int idx, unsigned long base_addr, unsign
  */
 csi_status_t csi_pmp_get_entry(unsigned int idx, unsigned long *base_addr, unsigned long *size, unsigned char *pmp_attr);
 
+/*
+ * Get the granularity G of the calling hart's PMP, for which the grain size is
+ * 2^(G+2) bytes.  This is discovered by writing all ones to the pmpaddr register
+ * of an unlocked, disabled entry and counting the trailing zeros read back,
+ * restoring the register afterwards.  The result may be passed to
+ * csi_pmp_plan_layout and csi_pmp_profile_build. This function only can be called
+ * in M-mode.
+ *
+ * @return : Granularity G; -1 will be returned as an error code if the hart has no
+ * PMP, or no entry is available which is both unlocked and disabled.
+ */
+int csi_pmp_get_granularity(void);
+
+/*
+ * Compute the PMP entries needed to describe a list of memory regions, without
+ * programming them.  Each region is encoded as a single NAPOT entry where its size
+ * is a power of two of at least 8 bytes (at least the grain size, if larger) and
+ * its base address is aligned to its size, as a single NA4 entry where its size is
+ * 4 bytes and the granularity is 0, and otherwise as a TOR entry.  A TOR entry
+ * takes its base address from the preceding entry, so a TOR region which
+ * immediately follows another TOR region in memory shares that region's entry as
+ * its base and needs only one entry; any other TOR region is preceded by an extra
+ * disabled entry holding its base address.  Where a region could be encoded either
+ * way, the encoding is chosen so that the whole layout uses the fewest entries.
+ * Regions are placed in entries in order of address. The PMP of a hart has a
+ * granularity G, which may be found using csi_pmp_get_granularity: regions are
+ * matched in grains of 2^(G+2) bytes, NA4 cannot be selected when G is greater
+ * than 0, and the low G bits of each pmpaddr register are ignored (TOR) or read as
+ * ones (NAPOT).  The base address and size of every region must therefore be
+ * multiples of the grain size, so that the computed entries take effect exactly as
+ * planned. This function only computes the layout and does not access any CSR, so
+ * it can be called in any mode, and can be built on a host to precompute layouts.
+ *
+ * @param regions: Array of regions to describe.  Regions must not overlap, and
+ * their base addresses and sizes must be multiples of the grain size.
+ * @param num_regions: Number of regions in the regions array.
+ * @param first_idx: Index of the first PMP entry to be used; entries below this
+ * (for example, locked entries set up by boot firmware) are left alone.  If
+ * first_idx is not 0, a TOR region placed at first_idx always needs an extra entry
+ * for its base address.
+ * @param granularity: PMP granularity G of the target hart, as returned by
+ * csi_pmp_get_granularity; the grain size is 2^(G+2) bytes.  Pass 0 for a PMP with
+ * 4-byte granularity.
+ * @param entries: Array to receive the computed entries, in order of entry index
+ * starting from first_idx.
+ * @param max_entries: Number of elements in the entries array.
+ * @return : Number of entries used, or an error code from csi_status_t.
+ * CSI_OUT_OF_MEM will be returned if the layout needs more than max_entries
+ * entries.  CSI_ERROR will be returned if regions overlap, or if the base address
+ * or size of any region is not a multiple of the grain size (4 bytes when
+ * granularity is 0), or if granularity is too large for CSI_PMP_XLEN.
+ */
+int csi_pmp_plan_layout(const csi_pmp_region_t *regions, unsigned int num_regions, unsigned int first_idx, unsigned int granularity, csi_pmp_entry_t *entries, unsigned int max_entries);
+
+/*
+ * Compute the PMP entries needed to describe a list of memory regions, as for
+ * csi_pmp_plan_layout, and program them into the PMP in a single pass.  The
+ * granularity used is that of the calling hart's PMP, as returned by
+ * csi_pmp_get_granularity.  Entries from first_idx upwards which are not needed by
+ * the layout are disabled.  Nothing is programmed if the layout does not fit in
+ * the entries available on the calling hart. This function only can be called in
+ * M-mode.  As for csi_pmp_set_entry, the new layout will not be effective until
+ * the core exits M-mode, unless it includes locked regions.
+ *
+ * @param regions: Array of regions to describe.  Regions must not overlap, and
+ * their base addresses and sizes must be multiples of the grain size.
+ * @param num_regions: Number of regions in the regions array.
+ * @param first_idx: Index of the first PMP entry to be used; entries below this
+ * are left alone.
+ * @return : Number of entries used, or an error code from csi_status_t.
+ * CSI_OUT_OF_MEM will be returned if the layout does not fit.  CSI_ERROR will be
+ * returned if regions overlap, if the base address or size of any region is not a
+ * multiple of the calling hart's PMP grain size, or if any entry from first_idx
+ * upwards is locked.
+ */
+int csi_pmp_apply_layout(const csi_pmp_region_t *regions, unsigned int num_regions, unsigned int first_idx);
+
+/*
+ * Build a PMP profile describing a list of memory regions, placed from entry
+ * first_idx upwards as by csi_pmp_plan_layout, for a hart whose PMP has the given
+ * granularity.  Entries below first_idx are copied from a base profile, and
+ * entries from first_idx upwards which are not needed by the layout are disabled.
+ * This function does not access any CSR, so it can be called in any mode, and can
+ * be built on a host to precompute profiles.
+ *
+ * @param profile: Profile to build.
+ * @param base: Profile from which entries below first_idx are copied, typically
+ * captured at startup using csi_pmp_profile_capture; or NULL, in which case those
+ * entries are disabled.
+ * @param regions: Array of regions to describe.  Regions must not overlap, and
+ * their base addresses and sizes must be multiples of the grain size.
+ * @param num_regions: Number of regions in the regions array.
+ * @param first_idx: Index of the first PMP entry to be used.
+ * @param granularity: PMP granularity G of the target hart, as returned by
+ * csi_pmp_get_granularity; the grain size is 2^(G+2) bytes.  Pass 0 for a PMP with
+ * 4-byte granularity.
+ * @return : Number of entries used from first_idx upwards, or an error code from
+ * csi_status_t.  CSI_OUT_OF_MEM will be returned if the layout needs more than the
+ * CSI_PMP_NUM_ENTRIES - first_idx entries available.  CSI_ERROR will be returned
+ * if regions overlap, or if the base address or size of any region is not a
+ * multiple of the grain size, as for csi_pmp_plan_layout.
+ */
+int csi_pmp_profile_build(csi_pmp_profile_t *profile, const csi_pmp_profile_t *base, const csi_pmp_region_t *regions, unsigned int num_regions, unsigned int first_idx, unsigned int granularity);
+
+/*
+ * Capture the current PMP configuration of the calling hart into a profile. This
+ * function only can be called in M-mode.
+ *
+ * @param profile: Profile to receive the configuration.
+ * @return : Status code
+ */
+csi_status_t csi_pmp_profile_capture(csi_pmp_profile_t *profile);
+
+/*
+ * Switch the PMP configuration of the calling hart from one profile to another.
+ * Only the pmpaddr and pmpcfg registers whose values differ between the two
+ * profiles are written, using a straight-line sequence of CSR writes with no loops
+ * over entries; no parameter validation is performed.  All pmpaddr registers are
+ * written before any pmpcfg register.  Writes to locked entries have no effect, so
+ * locked entries should be the same in both profiles. This function only can be
+ * called in M-mode.  As for csi_pmp_set_entry, the new configuration will not be
+ * effective until the core exits M-mode, so transient states during the switch are
+ * not observable by lower-privilege code.
+ *
+ * @param prev: Profile currently programmed into the PMP of the calling hart, or
+ * NULL if this is unknown, in which case all registers are written.
+ * @param next: Profile to switch to.
+ * @return : None
+ */
+void csi_pmp_switch(const csi_pmp_profile_t *prev, const csi_pmp_profile_t *next);
+
 
 #endif /* CSI_LL_PMP_H */ 
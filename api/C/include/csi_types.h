@@ -44,7 +44,9 @@ typedef void (csi_isr_t)(int source, void *isr_ctx, unsigned long mtval);
  * Function prototype for a delay function to be used when polling.  In non-
  * threaded systems this function could just contain noops, so the system will
  * busy-wait.  In threaded systems this may implement a timed delay which allows
- * other processes to execute while waiting.
+ * other processes to execute while waiting.  The calibrated delay functions
+ * csi_delay_us and csi_delay_wfi_us, from the low-level delay API, match this
+ * prototype.
  *
  * @param wait_time_us: Wait time in microseconds.  This may be ignored if the wait
  * is implemented as noops.
@@ -210,19 +210,19 @@ def generate_c(api_definition, module_definitions, out_dir):
             if module['no-assembler']:
                 out_str += "#ifndef __ASSEMBLER__\n\n"
         
+        # Add code fragments (ahead of types, so that types may use the definitions)
+        if 'c-definitions' in module.keys():
+            for fragment in module['c-definitions']:
+                out_str +=  "/*\n " + format_c_comment_lines(fragment['comment']) + "*/\n"
+                out_str += fragment['fragment'] + '\n'
+            out_str += "\n"
+
         # Add type declarations
         if 'c-type-declarations' in module.keys():
             for type_declaration in module['c-type-declarations']:
                 out_str += format_c_type_declaration(type_declaration)
                 out_str += "\n"
             out_str += "\n"
-            
-        # Add code fragments
-        if 'c-definitions' in module.keys():
-            for fragment in module['c-definitions']:
-                out_str +=  "/*\n " + format_c_comment_lines(fragment['comment']) + "*/\n"
-                out_str += fragment['fragment'] + '\n'
-            out_str += "\n"
 
         # Add macros
         if 'macros' in module.keys():
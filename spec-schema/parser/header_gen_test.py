@@ -1,4 +1,4 @@
-import unittest, header_gen
+import unittest, tempfile, pathlib, header_gen
 
 class Test_Parser_Units(unittest.TestCase):
     def test_should_format_include_statements(self):
@@ -7,5 +7,19 @@ class Test_Parser_Units(unittest.TestCase):
         include_file = {'filename':'csi.h', 'system-header':False}
         self.assertEqual(header_gen.format_c_include_file(include_file), "#include \"csi.h\"\n")
 
+    def test_should_place_definitions_before_type_declarations(self):
+        api_definition = {'boilerplate':'Boilerplate'}
+        module = {'module': {
+            'name':'Test module',
+            'description':'Test module description',
+            'c-filename':'csi_test.h',
+            'c-definitions':[{'comment':'Array size', 'fragment':'#define CSI_TEST_SIZE (4)\n'}],
+            'c-type-declarations':[{'name':'csi_test_t', 'description':'Test struct', 'type':'struct',
+                                    'struct-members':[{'name':'a[CSI_TEST_SIZE]', 'type':'int'}]}]}}
+        with tempfile.TemporaryDirectory() as out_dir:
+            header_gen.generate_c(api_definition, [module], out_dir)
+            header = pathlib.Path(out_dir, 'csi_test.h').read_text()
+        self.assertLess(header.index('#define CSI_TEST_SIZE'), header.index('typedef struct'))
+
 if __name__ == '__main__':
-    unittest.main()
\ No newline at end of file
+    unittest.main()